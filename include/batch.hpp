@@ -0,0 +1,39 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include "search.hpp"
+#include "transposition_table.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+namespace chess {
+
+struct BatchReport {
+  uint64_t positions = 0;
+  uint64_t invalid = 0; // Lines that were not valid FENs
+  uint64_t nodes = 0;
+};
+
+// Non-UCI analysis of a stream of FENs, one per line. Positions are searched
+// concurrently, one per worker thread, with a shared hash table. Each result
+// is written as one JSON object per line, in input order:
+//   {"fen":...,"depth":d,"score":{"cp":n} or {"mate":n},"bestmove":"e2e4",
+//    "pv":[...],"nodes":n,"time":ms,"evalcache":{"hits":n,"misses":n}}
+// Invalid lines produce {"fen":...,"error":...}; blank lines are skipped.
+class BatchAnalyzer {
+public:
+  BatchAnalyzer(int threads, size_t hashMegabytes);
+
+  BatchReport run(std::istream &in, std::ostream &out,
+                  const SearchLimits &limits);
+  const TranspositionTable &getHashTable() const;
+
+private:
+  int threads_;
+  TranspositionTable tt_;
+};
+
+} // namespace chess
+
+#endif // BATCH_HPP
@@ -0,0 +1,18 @@
+#ifndef BITBASE_HPP
+#define BITBASE_HPP
+
+#include "constants.hpp"
+
+namespace chess {
+namespace bitbase {
+
+// King and pawn versus king. Squares are row * BOARD_SIZE + col with the
+// pawn side playing up the board as White; the caller normalizes Black
+// pawns by flipping ranks. The table is built by retrograde analysis on
+// first use (about 200 KB of work, once per process).
+bool probeKPK(int strongKing, int strongPawn, int weakKing, bool strongToMove);
+
+} // namespace bitbase
+} // namespace chess
+
+#endif // BITBASE_HPP
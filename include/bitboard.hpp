@@ -0,0 +1,122 @@
+#ifndef BITBOARD_HPP
+#define BITBOARD_HPP
+
+#include "constants.hpp"
+#include <cstdint>
+
+namespace chess {
+
+// One bit per square, bit index row * BOARD_SIZE + col (a1 = 0, h8 = 63).
+using Bitboard = uint64_t;
+
+constexpr Bitboard FILE_A = 0x0101010101010101ULL;
+constexpr Bitboard RANK_1 = 0xFFULL;
+
+constexpr Bitboard squareBit(int row, int col) {
+  return Bitboard(1) << (row * BOARD_SIZE + col);
+}
+
+constexpr Bitboard fileMask(int col) { return FILE_A << col; }
+
+constexpr Bitboard rankMask(int row) { return RANK_1 << (row * BOARD_SIZE); }
+
+constexpr Bitboard adjacentFilesMask(int col) {
+  return (col > 0 ? fileMask(col - 1) : 0) |
+         (col < BOARD_SIZE - 1 ? fileMask(col + 1) : 0);
+}
+
+// Ranks strictly in front of the given row from the color's point of view.
+constexpr Bitboard forwardRanksMask(Color color, int row) {
+  return color == Color::WHITE
+             ? (row < BOARD_SIZE - 1 ? ~Bitboard(0) << ((row + 1) * BOARD_SIZE)
+                                     : 0)
+             : (row > 0 ? ~Bitboard(0) >> ((BOARD_SIZE - row) * BOARD_SIZE)
+                        : 0);
+}
+
+// Squares attacked by all pawns of the given color.
+constexpr Bitboard pawnAttacks(Color color, Bitboard pawns) {
+  constexpr Bitboard NOT_FILE_A = ~FILE_A;
+  constexpr Bitboard NOT_FILE_H = ~(FILE_A << (BOARD_SIZE - 1));
+  return color == Color::WHITE
+             ? ((pawns & NOT_FILE_A) << 7) | ((pawns & NOT_FILE_H) << 9)
+             : ((pawns & NOT_FILE_A) >> 9) | ((pawns & NOT_FILE_H) >> 7);
+}
+
+inline int popCount(Bitboard bits) { return __builtin_popcountll(bits); }
+
+inline int lsb(Bitboard bits) { return __builtin_ctzll(bits); }
+
+inline int msb(Bitboard bits) { return 63 - __builtin_clzll(bits); }
+
+// Remove and return the lowest set square.
+inline int popLsb(Bitboard &bits) {
+  int square = lsb(bits);
+  bits &= bits - 1;
+  return square;
+}
+
+// Attack sets by square, for code that asks which pieces reach a square
+// rather than where one piece goes.
+struct AttackTables {
+  Bitboard knight[BOARD_SIZE * BOARD_SIZE];
+  Bitboard king[BOARD_SIZE * BOARD_SIZE];
+  // Empty-board rays; directions 0-3 run towards higher squares.
+  Bitboard ray[8][BOARD_SIZE * BOARD_SIZE];
+};
+
+inline constexpr int RAY_STEPS[8][2] = {{1, 0},  {0, 1},  {1, 1},  {1, -1},
+                                        {-1, 0}, {0, -1}, {-1, -1}, {-1, 1}};
+
+constexpr AttackTables generateAttackTables() {
+  constexpr int KNIGHT_STEPS[8][2] = {{-2, -1}, {-2, 1}, {-1, -2}, {-1, 2},
+                                      {1, -2},  {1, 2},  {2, -1},  {2, 1}};
+  AttackTables tables{};
+  auto onBoard = [](int row, int col) {
+    return row >= 0 && row < BOARD_SIZE && col >= 0 && col < BOARD_SIZE;
+  };
+  for (int square = 0; square < BOARD_SIZE * BOARD_SIZE; ++square) {
+    const int row = square / BOARD_SIZE, col = square % BOARD_SIZE;
+    for (const auto &step : KNIGHT_STEPS)
+      if (onBoard(row + step[0], col + step[1]))
+        tables.knight[square] |= squareBit(row + step[0], col + step[1]);
+    for (int direction = 0; direction < 8; ++direction) {
+      const int dr = RAY_STEPS[direction][0], dc = RAY_STEPS[direction][1];
+      if (onBoard(row + dr, col + dc))
+        tables.king[square] |= squareBit(row + dr, col + dc);
+      for (int r = row + dr, c = col + dc; onBoard(r, c); r += dr, c += dc)
+        tables.ray[direction][square] |= squareBit(r, c);
+    }
+  }
+  return tables;
+}
+
+inline constexpr AttackTables ATTACKS = generateAttackTables();
+
+inline Bitboard knightAttacks(int square) { return ATTACKS.knight[square]; }
+
+inline Bitboard kingAttacks(int square) { return ATTACKS.king[square]; }
+
+// A ray cut after its first occupied square, which stays included.
+inline Bitboard rayAttacks(int direction, int square, Bitboard occupied) {
+  const Bitboard ray = ATTACKS.ray[direction][square];
+  const Bitboard blockers = ray & occupied;
+  if (!blockers)
+    return ray;
+  const int blocker = direction < 4 ? lsb(blockers) : msb(blockers);
+  return ray ^ ATTACKS.ray[direction][blocker];
+}
+
+inline Bitboard rookAttacks(int square, Bitboard occupied) {
+  return rayAttacks(0, square, occupied) | rayAttacks(1, square, occupied) |
+         rayAttacks(4, square, occupied) | rayAttacks(5, square, occupied);
+}
+
+inline Bitboard bishopAttacks(int square, Bitboard occupied) {
+  return rayAttacks(2, square, occupied) | rayAttacks(3, square, occupied) |
+         rayAttacks(6, square, occupied) | rayAttacks(7, square, occupied);
+}
+
+} // namespace chess
+
+#endif // BITBOARD_HPP
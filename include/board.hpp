@@ -1,25 +1,122 @@
 #ifndef BOARD_HPP
 #define BOARD_HPP
 
+#include "bitboard.hpp"
 #include "constants.hpp"
+#include "move.hpp"
 #include "piece.hpp"
 #include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace chess {
 
+// A piece that changed square in one move. A square of -1 means the piece
+// entered (from) or left (to) the board.
+struct DirtyPiece {
+  Piece piece;
+  int8_t from;
+  int8_t to;
+};
+
+// Everything one move changed on the board, for incremental evaluation. At
+// most three entries: a promotion with capture, or castling.
+struct DirtyPieces {
+  int count = 0;
+  std::array<DirtyPiece, 3> pieces;
+};
+
 class Board {
 public:
   Board(); // Constructor for initial setup
 
+  // Load a position in Forsyth-Edwards Notation; the two move clocks may be
+  // left out, as in EPD. Invalid or impossible positions are rejected and
+  // leave the board empty. Allocation-free once the board exists.
+  bool fromFEN(std::string_view fen);
+  std::string toFEN() const;
+
   const Piece &getPiece(int row,
                         int col) const; // Access a piece at a given square
   void setPiece(int row, int col,
                 const Piece &piece); // Place a piece on the board
   void printBoard() const;           // print the board for debugging purpose.
   void clear();                      // Clear the board
+  uint64_t getHash() const;          // Zobrist key of the position
+  uint64_t getPawnKey() const;       // Zobrist key of the pawns alone
+  uint64_t getMaterialKey() const;   // Key of the piece counts alone
+
+  Color getSideToMove() const;
+  void setSideToMove(Color color);
+  int getCastlingRights() const; // CastlingRight bit set
+  void setCastlingRights(int rights);
+  int getEnPassantCol() const; // File of the en passant target, -1 if none
+  void setEnPassantCol(int col);
+  int getHalfmoveClock() const;
+  int getFullmoveNumber() const;
+
+  // Play and take back a pseudo-legal move of the side to move. Castling,
+  // en passant and promotions are recognised from the move itself.
+  void makeMove(const Move &move);
+  void unmakeMove(const Move &move);
+  // Pass the turn: flips the side to move and the hash (and clears the en
+  // passant square). Used by null-move pruning.
+  void makeNullMove();
+  void unmakeNullMove();
+
+  bool isSquareAttacked(int row, int col, Color byColor) const;
+  bool isInCheck(Color color) const;
+  bool isRepetition() const; // Position occurred before since the last
+                             // irreversible move
+  bool isDraw() const;       // Fifty-move rule or repetition
+
+  int getPieceCount(Color color, PieceType type) const;
+  Bitboard getPieces(Color color, PieceType type) const;
+  Bitboard getPawns(Color color) const;
+  Bitboard getOccupied(Color color) const; // Every piece of one side
+  int getKingSquare(Color color) const; // row * BOARD_SIZE + col, -1 if none
+
+  // Material plus piece-square totals from White's point of view, kept up to
+  // date by setPiece.
+  int getMidgameScore() const;
+  int getEndgameScore() const;
+  bool hasNonPawnMaterial(Color color) const; // Any knight, bishop, rook or
+                                              // queen
+
+  // Moves made so far that can be taken back. Position i of the history is
+  // the one before move i; position getHistorySize() is the current one.
+  int getHistorySize() const;
+  uint64_t getHistoryHash(int index) const;
+  const DirtyPieces &getDirtyPieces(int index) const; // Made by move index
 
 private:
+  struct StateInfo {
+    Piece captured;
+    bool enPassant;
+    int castlingRights;
+    int enPassantCol;
+    int halfmoveClock;
+    uint64_t hash;
+    DirtyPieces dirty;
+  };
+
   std::array<std::array<Piece, BOARD_SIZE>, BOARD_SIZE> squares_;
+  uint64_t hash_;
+  uint64_t pawnKey_;
+  uint64_t materialKey_;
+  Color sideToMove_;
+  int castlingRights_;
+  int enPassantCol_;
+  int halfmoveClock_;
+  int fullmoveNumber_;
+  std::array<int, 2> kingSquare_; // row * BOARD_SIZE + col, -1 if absent
+  std::array<std::array<int, 7>, 2> pieceCount_; // [color][type]
+  std::array<std::array<Bitboard, 7>, 2> pieces_; // [color][type]
+  int midgameScore_;
+  int endgameScore_;
+  std::vector<StateInfo> history_;
 };
 
 } // namespace chess
@@ -0,0 +1,48 @@
+#ifndef BOOK_HPP
+#define BOOK_HPP
+
+#include "board.hpp"
+#include "mapped_file.hpp"
+#include "move.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace chess {
+
+// Key of a position by Polyglot's rules: the xor of piece-square, castling,
+// en passant (only when a pawn can take) and side-to-move terms drawn from
+// Polyglot's table of 781 random numbers, so any Polyglot book can be read.
+uint64_t bookKey(const Board &board);
+
+// Polyglot move encoding; castling is written as the king taking its rook.
+uint16_t encodeBookMove(const Board &board, const Move &move);
+
+struct BookMove {
+  Move move;
+  uint16_t weight;
+};
+
+// Polyglot-format opening book: 16-byte big-endian entries (key, move,
+// weight, learn) sorted by key. The file is memory-mapped and searched in
+// place, so opening is instant and probes from several threads are safe.
+class OpeningBook {
+public:
+  bool open(const std::string &path); // Closes any book already open
+  void close();
+  bool isOpen() const;
+  size_t size() const; // Entries
+
+  // The legal book moves of the position, heaviest first.
+  std::vector<BookMove> probe(Board &board) const;
+  // The heaviest move, or one drawn in proportion to the weights using
+  // `random`. The null move when the position is not in the book.
+  Move pickMove(Board &board, bool best, uint64_t random) const;
+
+private:
+  MappedFile file_;
+};
+
+} // namespace chess
+
+#endif // BOOK_HPP
@@ -0,0 +1,41 @@
+#ifndef BOOK_BUILDER_HPP
+#define BOOK_BUILDER_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace chess {
+
+struct BookBuildReport {
+  uint64_t games = 0;   // Games that were counted
+  uint64_t skipped = 0; // Without a result, or with an unreadable move
+  uint64_t moves = 0;   // Positions counted, at most maxPly per game
+  uint64_t entries = 0; // Written to the book
+};
+
+// Builds a Polyglot book (see OpeningBook) from PGN text. The text is split
+// at game boundaries and read in parallel. Each worker counts wins, draws
+// and losses per (position, move) over the first maxPly plies into its own
+// hash maps, sharded by the top bits of the key. The shards are then merged
+// in parallel and, being key ranges, written one after the other already in
+// order. As in Polyglot, a move is worth 2 per win and 1 per draw for the
+// side that played it, scaled to 16 bits per position. Moves played in
+// fewer than minGames games, or without a point, are left out.
+class BookBuilder {
+public:
+  BookBuilder(int threads, int maxPly, uint32_t minGames);
+
+  // False if the book cannot be written.
+  bool build(std::string_view pgn, const std::string &path,
+             BookBuildReport &report);
+
+private:
+  int threads_;
+  int maxPly_;
+  uint32_t minGames_;
+};
+
+} // namespace chess
+
+#endif // BOOK_BUILDER_HPP
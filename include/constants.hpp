@@ -19,6 +19,20 @@ enum class PieceType : uint8_t {
 
 constexpr int BOARD_SIZE = 8;
 
+// Castling rights, stored as a bit set on the board.
+enum CastlingRight : int {
+  NO_CASTLING = 0,
+  WHITE_KINGSIDE = 1,
+  WHITE_QUEENSIDE = 2,
+  BLACK_KINGSIDE = 4,
+  BLACK_QUEENSIDE = 8,
+  ALL_CASTLING = 15
+};
+
+constexpr Color opposite(Color color) {
+  return color == Color::WHITE ? Color::BLACK : Color::WHITE;
+}
+
 } // namespace chess
 
 #endif // CONSTANTS_HPP
@@ -0,0 +1,35 @@
+#ifndef ENDGAME_HPP
+#define ENDGAME_HPP
+
+#include "board.hpp"
+
+namespace chess {
+namespace endgame {
+
+// Added to scores of endings that are won with correct play but whose mate
+// is beyond the search horizon; well below the mate range.
+constexpr int VALUE_KNOWN_WIN = 10000;
+
+// Scale factors for the endgame half of the evaluation, out of NORMAL.
+constexpr int SCALE_DRAW = 0;
+constexpr int SCALE_ONE_PAWN = 32;
+constexpr int SCALE_NORMAL = 64;
+constexpr int SCALE_NONE = -1; // Scale function does not apply
+
+// Exact evaluation of a recognized ending, from the strong side's view.
+using EvaluationFunction = int (*)(const Board &board, Color strong);
+// Scale factor for the strong side, or SCALE_NONE.
+using ScaleFunction = int (*)(const Board &board, Color strong);
+
+int evaluateKXK(const Board &board, Color strong); // Mating material vs king
+int evaluateKBNK(const Board &board, Color strong);
+int evaluateKPK(const Board &board, Color strong);
+int evaluateKNNK(const Board &board, Color strong); // Knights cannot mate
+
+int scaleKBPsK(const Board &board, Color strong); // Wrong rook-pawn bishop
+int scaleOppositeBishops(const Board &board, Color strong);
+
+} // namespace endgame
+} // namespace chess
+
+#endif // ENDGAME_HPP
@@ -0,0 +1,56 @@
+#ifndef EPD_HPP
+#define EPD_HPP
+
+#include "board.hpp"
+#include "search.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace chess {
+
+// One position of an EPD test suite such as WAC or STS.
+struct EpdPosition {
+  std::string fen; // The four EPD position fields
+  std::string id;
+  std::vector<Move> bestMoves;  // bm: playing any of them solves it
+  std::vector<Move> avoidMoves; // am: playing any of them fails it
+};
+
+struct EpdReport {
+  int total = 0;
+  int solved = 0;
+  uint64_t nodes = 0;
+  int64_t time = 0; // Wall-clock milliseconds for the whole suite
+};
+
+// Parses one EPD record. bm and am moves are SAN. Returns false with a
+// reason for malformed records and for records with nothing to solve.
+bool parseEpd(std::string_view line, EpdPosition &position,
+              std::string &error);
+
+// Solves positions in parallel, one per worker thread at a time. Each worker
+// owns a search and a hash table of hashMegabytes, cleared before every
+// position so that node-limited runs are reproducible. onResult is called
+// for each finished position, from one worker at a time.
+class EpdRunner {
+public:
+  using ResultCallback = std::function<void(
+      const EpdPosition &position, const SearchResult &result, bool solved)>;
+
+  EpdRunner(int threads, size_t hashMegabytes);
+
+  EpdReport run(const std::vector<EpdPosition> &positions,
+                const SearchLimits &limits, const ResultCallback &onResult);
+
+private:
+  int threads_;
+  size_t hashMegabytes_;
+};
+
+} // namespace chess
+
+#endif // EPD_HPP
@@ -0,0 +1,41 @@
+#ifndef EVAL_CACHE_HPP
+#define EVAL_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace chess {
+
+// Per-thread direct-mapped cache of static evaluations keyed by the board
+// hash. The low bits pick the slot and the top 15 bits verify it, which
+// leaves rare false hits; search tolerates those like any other hash
+// collision.
+class EvalCache {
+public:
+  static constexpr size_t ENTRY_COUNT = 1 << 16; // 256 KB
+
+  EvalCache();
+
+  bool probe(uint64_t key, int &eval); // Counts a hit or a miss
+  void store(uint64_t key, int eval);
+  void clear(); // Entries and counters
+
+  void resetCounters();
+  uint64_t getHits() const;
+  uint64_t getMisses() const;
+
+private:
+  struct Entry {
+    uint16_t check = 0; // Zero when empty
+    int16_t eval = 0;
+  };
+
+  std::vector<Entry> entries_;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+};
+
+} // namespace chess
+
+#endif // EVAL_CACHE_HPP
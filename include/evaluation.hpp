@@ -0,0 +1,49 @@
+#ifndef EVALUATION_HPP
+#define EVALUATION_HPP
+
+#include "board.hpp"
+#include "eval_cache.hpp"
+#include "material.hpp"
+#include "nnue.hpp"
+#include "pawn_table.hpp"
+
+namespace chess {
+
+constexpr int PIECE_VALUES[7] = {0, 100, 320, 330, 500, 900, 0};
+
+inline int pieceValue(PieceType type) {
+  return PIECE_VALUES[static_cast<int>(type)];
+}
+
+inline int nonPawnMaterial(const Board &board, Color color) {
+  int total = 0;
+  for (PieceType type : {PieceType::KNIGHT, PieceType::BISHOP,
+                         PieceType::ROOK, PieceType::QUEEN})
+    total += board.getPieceCount(color, type) * pieceValue(type);
+  return total;
+}
+
+// Static evaluation: the NNUE network when one is loaded, the classical
+// terms otherwise. Owns hash tables and accumulators, so each search thread
+// needs its own instance. Results are cached by position, so clear() after
+// loading a network.
+class Evaluator {
+public:
+  int evaluate(const Board &board); // Score for the side to move
+  void clear();                     // Drop every cached result
+
+  const EvalCache &getCache() const;
+  void resetCacheCounters();
+
+private:
+  int computeEvaluation(const Board &board);
+
+  EvalCache cache_;
+  PawnTable pawnTable_;
+  MaterialTable materialTable_;
+  nnue::AccumulatorStack accumulators_;
+};
+
+} // namespace chess
+
+#endif // EVALUATION_HPP
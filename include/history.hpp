@@ -0,0 +1,53 @@
+#ifndef HISTORY_HPP
+#define HISTORY_HPP
+
+#include "constants.hpp"
+#include "move.hpp"
+#include <array>
+#include <cstdint>
+
+namespace chess {
+
+constexpr int MAX_HISTORY = 16384;
+constexpr int PIECE_INDEX_COUNT = 12; // color * 6 + type - 1
+
+inline int pieceIndex(Color color, PieceType type) {
+  return static_cast<int>(color) * 6 + static_cast<int>(type) - 1;
+}
+
+inline int squareIndex(int row, int col) { return row * BOARD_SIZE + col; }
+
+// Scores for one context, indexed [piece][to]. All moves of a node read the
+// same 1.5 KB block.
+using PieceToHistory =
+    std::array<std::array<int16_t, BOARD_SIZE * BOARD_SIZE>, PIECE_INDEX_COUNT>;
+
+// Move-ordering statistics owned by one search thread. Allocated once and
+// cleared between games.
+struct HistoryTables {
+  static constexpr int MAX_KILLER_PLY = 130;
+
+  // Butterfly history [color][from][to].
+  std::array<std::array<std::array<int16_t, 64>, 64>, 2> butterfly;
+  // Continuation history [previous piece][previous to][piece][to]; the same
+  // table serves the one- and two-ply contexts.
+  std::array<std::array<PieceToHistory, 64>, PIECE_INDEX_COUNT> continuation;
+  // Two quiet moves per ply that recently caused a beta cutoff.
+  std::array<std::array<Move, 2>, MAX_KILLER_PLY> killers;
+
+  void clear();
+  void clearKillers();
+  void storeKiller(int ply, const Move &move);
+};
+
+// Gravity update: the bonus shrinks as the entry approaches +-MAX_HISTORY,
+// so scores stay bounded and recent results outweigh old ones.
+inline void updateHistory(int16_t &entry, int bonus) {
+  int value = entry;
+  value += bonus - value * (bonus < 0 ? -bonus : bonus) / MAX_HISTORY;
+  entry = static_cast<int16_t>(value);
+}
+
+} // namespace chess
+
+#endif // HISTORY_HPP
@@ -0,0 +1,42 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace chess {
+
+// Read-only view of a whole file, memory-mapped where the platform allows
+// and read into memory otherwise. Safe to read from several threads.
+class MappedFile {
+public:
+  // Hint for the kernel's read-ahead.
+  enum class Access { SEQUENTIAL, RANDOM };
+
+  MappedFile() = default;
+  ~MappedFile();
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  // Closes any file already open.
+  bool open(const std::string &path, Access access = Access::SEQUENTIAL);
+  void close();
+
+  bool isOpen() const;
+  const unsigned char *data() const;
+  size_t size() const;
+  std::string_view view() const;
+
+private:
+  const unsigned char *data_ = nullptr;
+  size_t size_ = 0;
+  bool open_ = false;
+  bool mapped_ = false;
+  std::vector<unsigned char> buffer_; // Without mmap
+};
+
+} // namespace chess
+
+#endif // MAPPED_FILE_HPP
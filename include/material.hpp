@@ -0,0 +1,48 @@
+#ifndef MATERIAL_HPP
+#define MATERIAL_HPP
+
+#include "board.hpp"
+#include "endgame.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace chess {
+
+// Everything that depends only on the piece counts, worked out once per
+// material signature.
+struct MaterialEntry {
+  uint64_t key = 0;
+  int16_t midgameImbalance = 0; // White's point of view
+  int16_t endgameImbalance = 0;
+  uint8_t phase = 0;            // 0 (bare kings) to psqt::MAX_PHASE
+  // Specialized evaluation replacing the general one, if any.
+  endgame::EvaluationFunction evaluation = nullptr;
+  Color strongSide = Color::WHITE; // Side the evaluation function favours
+  // Endgame scaling by [color], applied when that color is ahead.
+  std::array<endgame::ScaleFunction, 2> scaleFunction{};
+  std::array<uint8_t, 2> scaleFactor{endgame::SCALE_NORMAL,
+                                     endgame::SCALE_NORMAL};
+
+  int scale(const Board &board, Color strong) const;
+};
+
+// Per-thread cache keyed by Board::getMaterialKey(). A game passes through
+// few material signatures, so the table can stay small.
+class MaterialTable {
+public:
+  static constexpr size_t ENTRY_COUNT = 1 << 13;
+
+  MaterialTable();
+
+  MaterialEntry &probe(const Board &board);
+  void clear();
+
+private:
+  std::vector<MaterialEntry> entries_;
+};
+
+} // namespace chess
+
+#endif // MATERIAL_HPP
@@ -2,6 +2,8 @@
 #define MOVE_HPP
 
 #include "constants.hpp"
+#include <cstdint>
+
 namespace chess {
 struct Move {
   int startRow;
@@ -10,9 +12,15 @@ struct Move {
   int endCol;
   PieceType promotionType;
 
+  Move(); // Null move (a1a1), used as "no move"
   Move(int startRow, int startCol, int endRow, int endCol,
        PieceType promotionType = PieceType::NONE);
   bool operator==(const Move &other) const;
+  bool operator!=(const Move &other) const;
+
+  // 16-bit encoding (from | to << 6 | promotion << 12) for compact tables.
+  uint16_t pack() const;
+  static Move unpack(uint16_t packed);
 };
 } // namespace chess
 #endif
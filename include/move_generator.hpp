@@ -3,25 +3,62 @@
 
 #include "board.hpp"
 #include "move.hpp"
+#include <array>
 #include <vector>
 namespace chess {
+
+// Fixed-capacity move buffer so the search can generate without allocating.
+class MoveList {
+public:
+  static constexpr int CAPACITY = 256;
+
+  template <typename... Args> void emplace_back(Args &&...args) {
+    moves_[size_++] = Move(args...);
+  }
+  void push_back(const Move &move) { moves_[size_++] = move; }
+  void clear() { size_ = 0; }
+  int size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  Move &operator[](int index) { return moves_[index]; }
+  const Move &operator[](int index) const { return moves_[index]; }
+  Move *begin() { return moves_.data(); }
+  Move *end() { return moves_.data() + size_; }
+  const Move *begin() const { return moves_.data(); }
+  const Move *end() const { return moves_.data() + size_; }
+
+private:
+  std::array<Move, CAPACITY> moves_;
+  int size_ = 0;
+};
+
 class MoveGenerator {
 public:
   std::vector<Move> generateMoves(const Board &board, Color color) const;
+  // Pseudo-legal moves; the caller rejects moves that leave the king in check.
+  void generateMoves(const Board &board, Color color, MoveList &moves) const;
+  // Captures (including en passant) and promotions only, for quiescence.
+  void generateCaptures(const Board &board, Color color,
+                        MoveList &moves) const;
 
 private:
-  void generatePawnMoves(const Board &board, int row, int col,
-                         std::vector<Move> &moves) const;
+  void generate(const Board &board, Color color, MoveList &moves,
+                bool capturesOnly) const;
+  void generatePawnMoves(const Board &board, int row, int col, MoveList &moves,
+                         bool capturesOnly) const;
   void generateKnightMoves(const Board &board, int row, int col,
-                           std::vector<Move> &moves) const;
+                           MoveList &moves, bool capturesOnly) const;
   void generateBishopMoves(const Board &board, int row, int col,
-                           std::vector<Move> &moves) const;
-  void generateRookMoves(const Board &board, int row, int col,
-                         std::vector<Move> &moves) const;
+                           MoveList &moves, bool capturesOnly) const;
+  void generateRookMoves(const Board &board, int row, int col, MoveList &moves,
+                         bool capturesOnly) const;
   void generateQueenMoves(const Board &board, int row, int col,
-                          std::vector<Move> &moves) const;
-  void generateKingMoves(const Board &board, int row, int col,
-                         std::vector<Move> &moves) const;
+                          MoveList &moves, bool capturesOnly) const;
+  void generateKingMoves(const Board &board, int row, int col, MoveList &moves,
+                         bool capturesOnly) const;
+  void generateCastlingMoves(const Board &board, int row, int col,
+                             MoveList &moves) const;
+  void addPawnMove(int row, int col, int newRow, int newCol,
+                   MoveList &moves) const;
   bool isValidSquare(int row, int col) const;
   bool isOpponentPiece(const Board &board, int row, int col, Color color) const;
 };
@@ -0,0 +1,69 @@
+#ifndef NNUE_HPP
+#define NNUE_HPP
+
+#include "board.hpp"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace chess {
+namespace nnue {
+
+// HalfKP 256x2-32-32-1, the layout of the first generation of Stockfish
+// networks (.nnue files with version 0x7AF32F16). Each perspective sees the
+// non-king pieces relative to its own king square.
+constexpr int HALF_DIMENSIONS = 256;
+constexpr int PIECE_SQUARE_COUNT = 641; // 10 piece kinds x 64 squares + 1
+constexpr int INPUT_DIMENSIONS = 64 * PIECE_SQUARE_COUNT;
+constexpr int HIDDEN_DIMENSIONS = 32;
+
+// Load a network, replacing the current one only on success. Not safe
+// while a search is running.
+bool loadNetwork(const std::string &path);
+void unloadNetwork(); // Back to the classical evaluation
+bool isLoaded();
+const std::string &getDescription(); // Text stored in the file header
+
+// First-layer sums of one position for both perspectives.
+struct alignas(64) Accumulator {
+  std::array<std::array<int16_t, HALF_DIMENSIONS>, 2> values;
+  uint64_t key = 0;                // Board hash the values belong to
+  std::array<bool, 2> computed{}; // Per perspective
+};
+
+// The last accumulator half built for one king square, together with the
+// pieces it covers, so that a refresh only applies the difference to the
+// current position.
+struct alignas(64) RefreshEntry {
+  std::array<int16_t, HALF_DIMENSIONS> values;
+  std::array<std::array<Bitboard, 7>, 2> pieces; // [color][type]
+  bool valid = false;
+};
+
+// Per-thread accumulators following the board's move history. They are
+// computed lazily, when a position is evaluated: the nearest computed
+// ancestor on the current line is brought forward with the pieces each move
+// changed. A perspective whose king moved since then is refreshed from the
+// entry cached for its new king square.
+class AccumulatorStack {
+public:
+  AccumulatorStack();
+
+  int evaluate(const Board &board); // Centipawns for the side to move
+
+private:
+  Accumulator &update(const Board &board);
+  int findComputedAncestor(const Board &board, Color perspective) const;
+  void refresh(const Board &board, Accumulator &accumulator,
+               Color perspective);
+
+  std::vector<Accumulator> stack_; // Indexed like the board history
+  std::vector<RefreshEntry> refreshTable_; // [perspective * 64 + king]
+  uint32_t networkGeneration_ = 0;         // Network the caches belong to
+};
+
+} // namespace nnue
+} // namespace chess
+
+#endif // NNUE_HPP
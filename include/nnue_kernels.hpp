@@ -0,0 +1,31 @@
+#ifndef NNUE_KERNELS_HPP
+#define NNUE_KERNELS_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace chess {
+namespace nnue {
+
+// Inner loops of NNUE inference, one set per instruction set. All sets give
+// bit-identical results; the scalar one is the reference.
+struct Kernels {
+  const char *name;
+  // values[i] += weights[i] (or -=) over one accumulator half.
+  void (*addRow)(int16_t *values, const int16_t *weights);
+  void (*subtractRow)(int16_t *values, const int16_t *weights);
+  // output[i] = biases[i] + sum_j weights[i * inputs + j] * input[j], with
+  // inputs a multiple of 32.
+  void (*affine)(const uint8_t *input, int inputs, const int8_t *weights,
+                 const int32_t *biases, int outputs, int32_t *output);
+};
+
+// Kernel sets this CPU can run, fastest first; scalar is always last.
+std::vector<const Kernels *> supportedKernels();
+// The fastest supported set, chosen once per process.
+const Kernels &activeKernels();
+
+} // namespace nnue
+} // namespace chess
+
+#endif // NNUE_KERNELS_HPP
@@ -0,0 +1,27 @@
+#ifndef NOTATION_HPP
+#define NOTATION_HPP
+
+#include "board.hpp"
+#include "move.hpp"
+#include <string>
+#include <string_view>
+
+namespace chess {
+
+// Coordinate notation used by UCI, e.g. e2e4 or e7e8q.
+std::string moveToUci(const Move &move);
+// The legal move of the side to move written as text, or the null move.
+Move parseUciMove(Board &board, std::string_view text);
+
+// Standard algebraic notation, e.g. Nf3, exd5, O-O or e8=Q+, for a legal
+// move of the side to move. The board is restored before returning.
+std::string moveToSan(Board &board, const Move &move);
+// Accepts check marks, annotations (!, ?), a missing '=' or capture mark and
+// more disambiguation than needed. Returns the null move if no legal move,
+// or more than one, matches. Candidates come from the attack sets of the
+// target square, so no move list is generated.
+Move parseSanMove(Board &board, std::string_view text);
+
+} // namespace chess
+
+#endif // NOTATION_HPP
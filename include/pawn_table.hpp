@@ -0,0 +1,46 @@
+#ifndef PAWN_TABLE_HPP
+#define PAWN_TABLE_HPP
+
+#include "bitboard.hpp"
+#include "board.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace chess {
+
+// Cached pawn-structure terms for one pawn configuration. Scores are from
+// White's point of view.
+struct PawnEntry {
+  uint64_t key = 0;
+  int16_t midgameScore = 0;
+  int16_t endgameScore = 0;
+  std::array<Bitboard, 2> passedPawns{};
+  // King shelter depends on the king square too, so it is cached separately
+  // and recomputed only when the king has moved.
+  std::array<int8_t, 2> shelterKingSquare{-1, -1};
+  std::array<int16_t, 2> shelter{};
+};
+
+// Per-thread cache of pawn evaluations keyed by Board::getPawnKey(). Sibling
+// nodes rarely change the pawns, so nearly every probe is a hit.
+class PawnTable {
+public:
+  static constexpr size_t ENTRY_COUNT = 1 << 14; // 640 KB, 40-byte entries
+
+  PawnTable();
+
+  // Entry for the board's pawns, evaluated on a miss.
+  PawnEntry &probe(const Board &board);
+  // Midgame shelter bonus of color's king, cached in the entry.
+  int shelter(PawnEntry &entry, const Board &board, Color color) const;
+  void clear();
+
+private:
+  std::vector<PawnEntry> entries_;
+};
+
+} // namespace chess
+
+#endif // PAWN_TABLE_HPP
@@ -0,0 +1,51 @@
+#ifndef PGN_HPP
+#define PGN_HPP
+
+#include "board.hpp"
+#include "move.hpp"
+#include <functional>
+#include <string_view>
+#include <vector>
+
+namespace chess {
+
+// One game of a PGN file as views into the file's text, so it stays valid
+// only as long as the text does.
+struct PgnGame {
+  std::string_view tags;     // Tag pair section, possibly empty
+  std::string_view movetext; // Up to the next game's tags
+
+  // Value of a tag pair, empty if absent. Escapes are left in place.
+  std::string_view tag(std::string_view name) const;
+};
+
+// Iterates over the games of PGN text without copying or allocating.
+class PgnReader {
+public:
+  explicit PgnReader(std::string_view text);
+
+  bool next(PgnGame &game); // False once the text is exhausted
+
+private:
+  std::string_view text_;
+};
+
+// Called with the position before each move of the main line; returning
+// false ends the replay early.
+using PgnMoveCallback =
+    std::function<bool(const Board &board, const Move &move)>;
+
+// Plays the main line from the game's start position (its FEN tag, if any),
+// skipping comments, variations, NAGs and move numbers. Returns false if the
+// start position or a move cannot be read; the board is left where the
+// replay stopped. Allocation-free except for games over 1024 plies.
+bool replayPgnGame(const PgnGame &game, Board &board,
+                   const PgnMoveCallback &onMove);
+
+// Splits PGN text into at most `parts` pieces of similar size, each starting
+// at a game boundary, so that they can be read in parallel.
+std::vector<std::string_view> splitPgn(std::string_view text, int parts);
+
+} // namespace chess
+
+#endif // PGN_HPP
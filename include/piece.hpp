@@ -5,13 +5,15 @@
 
 namespace chess {
 
+// Inline: these run on every square the board and move generator look at.
 class Piece {
 public:
-  Piece(PieceType type = PieceType::NONE, Color color = Color::WHITE);
+  constexpr Piece(PieceType type = PieceType::NONE, Color color = Color::WHITE)
+      : type_(type), color_(color) {}
 
-  PieceType getType() const;
-  Color getColor() const;
-  bool isEmpty() const;
+  constexpr PieceType getType() const { return type_; }
+  constexpr Color getColor() const { return color_; }
+  constexpr bool isEmpty() const { return type_ == PieceType::NONE; }
 
 private:
   PieceType type_;
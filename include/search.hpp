@@ -0,0 +1,132 @@
+#ifndef SEARCH_HPP
+#define SEARCH_HPP
+
+#include "board.hpp"
+#include "evaluation.hpp"
+#include "history.hpp"
+#include "move_generator.hpp"
+#include "time_manager.hpp"
+#include "transposition_table.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace chess {
+
+constexpr int MAX_PLY = 128;
+constexpr int VALUE_DRAW = 0;
+constexpr int VALUE_MATE = 32000;
+constexpr int VALUE_INFINITE = 32001;
+constexpr int VALUE_MATE_IN_MAX_PLY = VALUE_MATE - MAX_PLY;
+// Results proven by the endgame tablebases, less the distance to the root.
+constexpr int VALUE_TB_WIN = VALUE_MATE_IN_MAX_PLY - 1;
+constexpr int VALUE_TB_WIN_IN_MAX_PLY = VALUE_TB_WIN - MAX_PLY;
+
+struct SearchLimits {
+  int depth = MAX_PLY - 1;
+  uint64_t nodes = 0; // 0 means no node limit
+  // Clock in milliseconds; all zero means no time control.
+  int64_t whiteTime = 0;
+  int64_t blackTime = 0;
+  int64_t whiteIncrement = 0;
+  int64_t blackIncrement = 0;
+  int movesToGo = 0;
+  int64_t moveTime = 0;
+  int64_t moveOverhead = 30; // Reserved for communication lag
+  bool infinite = false;
+  // Thinking on the opponent's time: the clock is ignored until ponderHit().
+  bool ponder = false;
+  std::vector<Move> searchMoves; // Root moves to consider, all if empty
+  // Tablebases are probed with at most syzygyProbeLimit pieces, and with
+  // exactly that many only from syzygyProbeDepth on.
+  int syzygyProbeDepth = 1;
+  int syzygyProbeLimit = 7;
+  bool syzygy50MoveRule = true; // Cursed wins and blessed losses are draws
+  // False when the caller ages the transposition table itself, e.g. once
+  // for many searches sharing it at the same time.
+  bool newSearch = true;
+};
+
+struct SearchResult {
+  Move bestMove;
+  int score = 0;
+  int depth = 0;
+  uint64_t nodes = 0;
+  int64_t time = 0; // Milliseconds
+  uint64_t evalCacheHits = 0; // Static evaluations served from the cache
+  uint64_t evalCacheMisses = 0;
+  uint64_t tbHits = 0; // Successful tablebase probes
+  std::vector<Move> pv;
+};
+
+// Iterative-deepening alpha-beta searcher. One instance per thread; the
+// transposition table may be shared. Nothing is allocated once think() runs.
+class Search {
+public:
+  // Called on the searching thread after every completed iteration.
+  using InfoCallback = std::function<void(const SearchResult &)>;
+
+  explicit Search(TranspositionTable &tt);
+
+  SearchResult think(Board &board, const SearchLimits &limits);
+  void stop();      // Safe to call from another thread
+  void ponderHit(); // The pondered move was played; likewise thread-safe
+  void setInfoCallback(InfoCallback callback);
+  void clear(); // Forget move-ordering statistics, e.g. between games
+  uint64_t getNodes() const;
+
+private:
+  int alphaBeta(Board &board, int alpha, int beta, int depth, int ply,
+                bool cutNode);
+  int quiescence(Board &board, int alpha, int beta, int ply);
+
+  void scoreMoves(const Board &board, const MoveList &moves, int *scores,
+                  const Move &ttMove, int ply) const;
+  int quietScore(const Board &board, const Move &move, int ply) const;
+  void updateQuietStats(const Board &board, int ply, int depth,
+                        const Move &bestMove, const Move *quiets,
+                        int quietCount);
+  static const Move &pickMove(MoveList &moves, int *scores, int index);
+  void rankRootMoves(Board &board);
+  bool shouldStop();
+  void updatePv(int ply, const Move &move);
+
+  // Per-ply state shared between a node and its children.
+  struct StackEntry {
+    Move currentMove;
+    Move excludedMove; // Skipped by the singular extension verification
+    PieceToHistory *continuationHistory = nullptr; // Context of currentMove
+    int staticEval = 0;
+    bool nullMove = false;
+  };
+
+  TranspositionTable &tt_;
+  MoveGenerator moveGen_;
+  Evaluator evaluator_;
+  SearchLimits limits_;
+  TimeManager timeManager_;
+  std::atomic<bool> stopped_{false};
+  std::atomic<bool> pondering_{false};
+  InfoCallback infoCallback_;
+  uint64_t nodes_ = 0;
+  std::vector<std::array<Move, MAX_PLY + 1>> pvTable_;
+  std::array<int, MAX_PLY + 1> pvLength_{};
+  std::array<StackEntry, MAX_PLY + 1> stack_{};
+  std::unique_ptr<HistoryTables> history_;
+  // Nodes spent below each root move [from][to], for time management.
+  std::array<std::array<uint64_t, 64>, 64> rootEffort_{};
+  // Tablebase probing in the tree: most pieces (0 for none) and the depth
+  // needed with that many.
+  int tbCardinality_ = 0;
+  int tbProbeDepth_ = 0;
+  uint64_t tbHits_ = 0;
+  bool rootInTb_ = false; // Root moves were filtered by the tablebases
+  int rootTbScore_ = 0;   // Reported instead of a search score below mate
+};
+
+} // namespace chess
+
+#endif // SEARCH_HPP
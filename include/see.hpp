@@ -0,0 +1,15 @@
+#ifndef SEE_HPP
+#define SEE_HPP
+
+#include "board.hpp"
+#include "move.hpp"
+
+namespace chess {
+
+// Static exchange evaluation: true if the capture sequence started by `move`
+// on its target square wins at least `threshold` for the side making it.
+bool seeGe(const Board &board, const Move &move, int threshold);
+
+} // namespace chess
+
+#endif // SEE_HPP
@@ -0,0 +1,55 @@
+#ifndef SYZYGY_HPP
+#define SYZYGY_HPP
+
+#include "board.hpp"
+#include "move.hpp"
+#include <string>
+#include <vector>
+
+namespace chess {
+namespace syzygy {
+
+// Win/draw/loss for the side to move. Cursed wins and blessed losses are
+// wins and losses that the fifty-move rule turns into draws.
+constexpr int WDL_LOSS = -2;
+constexpr int WDL_BLESSED_LOSS = -1;
+constexpr int WDL_DRAW = 0;
+constexpr int WDL_CURSED_WIN = 1;
+constexpr int WDL_WIN = 2;
+
+// Syzygy endgame tablebases: .rtbw files hold win/draw/loss and .rtbz files
+// distance to zeroing (the plies to the next capture or pawn move on a best
+// line). `paths` lists directories separated by ':' (';' on Windows). Every
+// table found is memory-mapped and indexed here, so probes take no locks
+// and may run on any number of threads. Returns the number of WDL tables;
+// not safe while a search is running.
+int init(const std::string &paths);
+int largest(); // Pieces in the biggest table, 0 when none is loaded
+
+// Positions with castling rights, more pieces than largest() or a missing
+// table cannot be probed and return false. probeWdl() holds for a position
+// reached by a capture or pawn move; with a nonzero clock, a cursed or
+// blessed result may already have become a draw.
+bool probeWdl(Board &board, int &wdl);
+// Plies to a zeroing move on the way to the result: positive when the side
+// to move wins, negative when it loses, 0 for a draw. Off by one either way
+// on the threshold of the fifty-move rule, as in the tables.
+bool probeDtz(Board &board, int &dtz);
+
+// Root moves ranked by the result they keep: 1000 wins within the fifty
+// moves left, lower positive ranks win later, 0 draws and -1000 loses, with
+// higher negative ranks for losses the rule may still save.
+struct RootMove {
+  Move move;
+  int rank = 0;
+};
+
+// Ranks legal root moves by DTZ; false if a table is missing.
+bool rankRootMoves(Board &board, std::vector<RootMove> &moves);
+// Ranks by WDL alone, for when only the .rtbw files are present.
+bool rankRootMovesByWdl(Board &board, std::vector<RootMove> &moves);
+
+} // namespace syzygy
+} // namespace chess
+
+#endif // SYZYGY_HPP
@@ -0,0 +1,40 @@
+#ifndef TIME_MANAGER_HPP
+#define TIME_MANAGER_HPP
+
+#include "constants.hpp"
+#include <chrono>
+#include <cstdint>
+
+namespace chess {
+
+struct SearchLimits;
+
+// Splits the clock into a soft limit, checked between iterations and scaled
+// by how settled the search is, and a hard limit that aborts the search.
+class TimeManager {
+public:
+  void start(const SearchLimits &limits, Color us);
+
+  bool isActive() const; // False for depth, node or infinite searches
+  int64_t elapsed() const; // Milliseconds since start()
+  int64_t getSoftLimit() const;
+  int64_t getHardLimit() const;
+  bool hardLimitReached() const;
+
+  // Called after each completed iteration. bestMoveStability counts the
+  // consecutive iterations with the same best move, scoreDrop is the fall
+  // in score since the previous iteration and bestMoveNodeShare the fraction
+  // of root nodes spent below the best move.
+  bool shouldStopIteration(int bestMoveStability, int scoreDrop,
+                           double bestMoveNodeShare) const;
+
+private:
+  std::chrono::steady_clock::time_point startTime_;
+  int64_t softLimit_ = 0;
+  int64_t hardLimit_ = 0;
+  bool active_ = false;
+};
+
+} // namespace chess
+
+#endif // TIME_MANAGER_HPP
@@ -0,0 +1,77 @@
+#ifndef TRANSPOSITION_TABLE_HPP
+#define TRANSPOSITION_TABLE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace chess {
+
+enum class Bound : uint8_t { NONE, UPPER, LOWER, EXACT };
+
+// Decoded view of a stored entry.
+struct TTEntry {
+  uint16_t move;
+  int16_t score;
+  int16_t eval;
+  int8_t depth;
+  Bound bound;
+};
+
+// Shared hash table. Entries are stored lock-free as two 64-bit words with the
+// key xor-ed against the payload, so torn writes from other threads are
+// detected on probe instead of returning a mixed entry.
+class TranspositionTable {
+public:
+  enum class Backing : uint8_t {
+    NONE,
+    HUGETLB,                // explicit 2 MB pages from the hugetlb pool
+    TRANSPARENT_HUGE_PAGES, // 2 MB aligned, madvise(MADV_HUGEPAGE)
+    SMALL_PAGES             // regular 4 KB pages
+  };
+
+  explicit TranspositionTable(size_t megabytes = 16, int threads = 1);
+  ~TranspositionTable();
+  TranspositionTable(const TranspositionTable &) = delete;
+  TranspositionTable &operator=(const TranspositionTable &) = delete;
+
+  void resize(size_t megabytes, int threads = 1); // Reallocates and clears
+  void clear(int threads = 1); // Zero the table, split across threads
+  void newSearch();            // Age existing entries
+
+  bool probe(uint64_t key, TTEntry &entry) const;
+  void store(uint64_t key, int depth, int score, int eval, Bound bound,
+             uint16_t move);
+  void prefetch(uint64_t key) const;
+  int hashfull() const; // Permille of recent entries in the first clusters
+
+  Backing getBacking() const;
+  const char *backingName() const;
+  size_t sizeInBytes() const;
+  std::string describe() const; // "Hash <N> MB backed by <backing>"
+
+private:
+  struct Slot {
+    std::atomic<uint64_t> check; // key ^ data
+    std::atomic<uint64_t> data;
+  };
+  static constexpr int SLOTS_PER_CLUSTER = 4;
+  struct alignas(64) Cluster {
+    Slot slots[SLOTS_PER_CLUSTER];
+  };
+
+  Cluster *clusterFor(uint64_t key) const;
+  void allocate(size_t bytes);
+  void release();
+
+  Cluster *table_ = nullptr;
+  size_t clusterCount_ = 0;
+  size_t allocatedBytes_ = 0;
+  Backing backing_ = Backing::NONE;
+  uint8_t generation_ = 0;
+};
+
+} // namespace chess
+
+#endif // TRANSPOSITION_TABLE_HPP
@@ -0,0 +1,73 @@
+#ifndef UCI_HPP
+#define UCI_HPP
+
+#include "board.hpp"
+#include "book.hpp"
+#include "search.hpp"
+#include "transposition_table.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace chess {
+
+// Universal Chess Interface front-end. Searches run on a worker thread, so
+// commands keep being read while the engine thinks and stop or ponderhit
+// take effect immediately.
+class Uci {
+public:
+  Uci(std::istream &in, std::ostream &out);
+  ~Uci();
+  Uci(const Uci &) = delete;
+  Uci &operator=(const Uci &) = delete;
+
+  void loop(); // Until quit or the end of the input
+  const TranspositionTable &getHashTable() const;
+
+private:
+  bool execute(const std::string &line); // False on quit
+  void identify();
+  void position(std::istringstream &args);
+  void go(std::istringstream &args);
+  void setOption(std::istringstream &args);
+  void ponderHit();
+  void solveEpd(std::istringstream &args);
+  void runSearch(SearchLimits limits);
+  void stopSearch(); // Stop the running search, if any, and wait for it
+  void sendInfo(const SearchResult &result);
+  void send(const std::string &line);
+
+  std::istream &in_;
+  std::ostream &out_;
+  std::mutex outputMutex_;
+  TranspositionTable tt_;
+  Search search_;
+  Board board_; // Searched in place; only touched while no search runs
+  int64_t moveOverhead_ = 30;
+  int hashMegabytes_;
+  OpeningBook book_;
+  bool ownBook_ = false;
+  bool bestBookMove_ = false; // Else drawn by weight
+  std::mt19937_64 random_;
+  int syzygyProbeDepth_ = 1;
+  int syzygyProbeLimit_ = 7;
+  bool syzygy50MoveRule_ = true;
+
+  std::thread searchThread_;
+  std::atomic<bool> searching_{false};
+  // Infinite and ponder searches hold back bestmove until released.
+  std::mutex releaseMutex_;
+  std::condition_variable releaseCondition_;
+  bool stopRequested_ = false;
+  bool ponderHitReceived_ = false;
+};
+
+} // namespace chess
+
+#endif // UCI_HPP
@@ -0,0 +1,57 @@
+#ifndef ZOBRIST_HPP
+#define ZOBRIST_HPP
+
+#include "constants.hpp"
+#include <cstdint>
+
+namespace chess {
+namespace zobrist {
+
+struct Keys {
+  uint64_t piece[2][7][BOARD_SIZE * BOARD_SIZE]; // [color][type][square]
+  uint64_t castling[16];
+  uint64_t enPassant[BOARD_SIZE]; // indexed by file
+  uint64_t side;                  // xor-ed in when black is to move
+};
+
+// splitmix64, so the keys are reproducible across builds and platforms.
+constexpr uint64_t nextRandom(uint64_t &state) {
+  uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+constexpr Keys generateKeys() {
+  Keys keys{};
+  uint64_t state = 0x2545F4914F6CDD1DULL;
+  for (int color = 0; color < 2; ++color)
+    for (int type = 0; type < 7; ++type)
+      for (int square = 0; square < BOARD_SIZE * BOARD_SIZE; ++square)
+        keys.piece[color][type][square] =
+            type == 0 ? 0 : nextRandom(state); // empty squares hash to 0
+  for (int rights = 1; rights < 16; ++rights) // no rights hash to 0
+    keys.castling[rights] = nextRandom(state);
+  for (auto &key : keys.enPassant)
+    key = nextRandom(state);
+  keys.side = nextRandom(state);
+  return keys;
+}
+
+inline constexpr Keys KEYS = generateKeys();
+
+inline uint64_t pieceKey(Color color, PieceType type, int row, int col) {
+  return KEYS.piece[static_cast<int>(color)][static_cast<int>(type)]
+                   [row * BOARD_SIZE + col];
+}
+
+// Material signatures hash the piece counts rather than the squares: the
+// key of n pieces of a kind is the xor of that kind's keys 0 .. n - 1.
+inline uint64_t materialKey(Color color, PieceType type, int count) {
+  return KEYS.piece[static_cast<int>(color)][static_cast<int>(type)][count];
+}
+
+} // namespace zobrist
+} // namespace chess
+
+#endif // ZOBRIST_HPP
@@ -0,0 +1,158 @@
+#include "batch.hpp"
+#include "notation.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace chess {
+
+namespace {
+
+// Results finished ahead of the next one to write, per worker. Bounds the
+// memory held back by a slow position.
+constexpr int REORDER_WINDOW_PER_THREAD = 8;
+
+void appendJsonString(std::string &json, const std::string &text) {
+  static constexpr char HEX[] = "0123456789abcdef";
+  json += '"';
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      json += '\\';
+      json += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      json += "\\u00";
+      json += HEX[(c >> 4) & 0xF];
+      json += HEX[c & 0xF];
+    } else {
+      json += c;
+    }
+  }
+  json += '"';
+}
+
+std::string analyze(Search &search, Board &board, const std::string &fen,
+                    const SearchLimits &limits, BatchReport &report) {
+  std::string json = "{\"fen\":";
+  appendJsonString(json, fen);
+  if (!board.fromFEN(fen)) {
+    ++report.invalid;
+    return json + ",\"error\":\"invalid FEN\"}";
+  }
+
+  SearchResult result = search.think(board, limits);
+  report.nodes += result.nodes;
+  json += ",\"depth\":" + std::to_string(result.depth) + ",\"score\":{";
+  if (result.score >= VALUE_MATE_IN_MAX_PLY)
+    json += "\"mate\":" + std::to_string((VALUE_MATE - result.score + 1) / 2);
+  else if (result.score <= -VALUE_MATE_IN_MAX_PLY)
+    json += "\"mate\":" + std::to_string(-(VALUE_MATE + result.score) / 2);
+  else
+    json += "\"cp\":" + std::to_string(result.score);
+  json += "},\"bestmove\":";
+  // No legal move: mate or stalemate, which the score tells apart.
+  if (result.pv.empty())
+    json += "null";
+  else
+    appendJsonString(json, moveToUci(result.bestMove));
+  json += ",\"pv\":[";
+  for (size_t i = 0; i < result.pv.size(); ++i) {
+    if (i > 0)
+      json += ',';
+    appendJsonString(json, moveToUci(result.pv[i]));
+  }
+  json += "],\"nodes\":" + std::to_string(result.nodes) +
+          ",\"time\":" + std::to_string(result.time) +
+          ",\"evalcache\":{\"hits\":" + std::to_string(result.evalCacheHits) +
+          ",\"misses\":" + std::to_string(result.evalCacheMisses) + "}}";
+  return json;
+}
+
+} // namespace
+
+BatchAnalyzer::BatchAnalyzer(int threads, size_t hashMegabytes)
+    : threads_(std::max(threads, 1)), tt_(hashMegabytes, threads_) {}
+
+const TranspositionTable &BatchAnalyzer::getHashTable() const { return tt_; }
+
+BatchReport BatchAnalyzer::run(std::istream &in, std::ostream &out,
+                               const SearchLimits &limits) {
+  const uint64_t window =
+      static_cast<uint64_t>(threads_) * REORDER_WINDOW_PER_THREAD;
+  std::vector<std::string> results(window);
+  std::vector<bool> finished(window, false);
+  uint64_t nextInput = 0, nextOutput = 0;
+  bool inputDone = false;
+  BatchReport report;
+  std::mutex mutex;
+  std::condition_variable slotFreed;
+
+  // Aged once for the whole batch: the workers search concurrently, and
+  // what one stores should stay current for the others.
+  tt_.newSearch();
+  SearchLimits shared = limits;
+  shared.newSearch = false;
+  auto worker = [&] {
+    auto search = std::make_unique<Search>(tt_);
+    Board board;
+    BatchReport local;
+    std::string line;
+    while (true) {
+      uint64_t index;
+      {
+        // Input is read under the lock, so lines are numbered in order.
+        std::unique_lock<std::mutex> lock(mutex);
+        slotFreed.wait(lock, [&] {
+          return inputDone || nextInput < nextOutput + window;
+        });
+        if (inputDone || !std::getline(in, line)) {
+          inputDone = true;
+          slotFreed.notify_all();
+          break;
+        }
+        index = nextInput++;
+      }
+
+      if (!line.empty() && line.back() == '\r')
+        line.pop_back();
+      std::string json;
+      if (line.find_first_not_of(" \t") != std::string::npos) {
+        ++local.positions;
+        json = analyze(*search, board, line, shared, local);
+      }
+
+      std::lock_guard<std::mutex> lock(mutex);
+      results[index % window] = std::move(json);
+      finished[index % window] = true;
+      while (finished[nextOutput % window]) {
+        std::string &ready = results[nextOutput % window];
+        if (!ready.empty())
+          out << ready << '\n' << std::flush;
+        ready.clear();
+        finished[nextOutput % window] = false;
+        ++nextOutput;
+      }
+      slotFreed.notify_all();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    report.positions += local.positions;
+    report.invalid += local.invalid;
+    report.nodes += local.nodes;
+  };
+
+  std::vector<std::thread> pool;
+  for (int i = 1; i < threads_; ++i)
+    pool.emplace_back(worker);
+  worker();
+  for (std::thread &thread : pool)
+    thread.join();
+  return report;
+}
+
+} // namespace chess
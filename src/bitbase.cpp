@@ -0,0 +1,158 @@
+#include "bitbase.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+namespace chess {
+namespace bitbase {
+
+namespace {
+
+// Pawn on files a-d and rows 1-6, both kings anywhere, either side to move.
+constexpr int MAX_INDEX = 2 * 24 * 64 * 64;
+
+enum Result : uint8_t { INVALID = 0, UNKNOWN = 1, DRAW = 2, WIN = 4 };
+
+int squareRow(int square) { return square / BOARD_SIZE; }
+int squareCol(int square) { return square % BOARD_SIZE; }
+
+int distance(int a, int b) {
+  return std::max(std::abs(squareRow(a) - squareRow(b)),
+                  std::abs(squareCol(a) - squareCol(b)));
+}
+
+int index(bool whiteToMove, int blackKing, int whiteKing, int pawn) {
+  return whiteKing | blackKing << 6 | (whiteToMove ? 0 : 1) << 12 |
+         squareCol(pawn) << 13 | (6 - squareRow(pawn)) << 15;
+}
+
+bool pawnAttacks(int pawn, int square) {
+  return squareRow(square) == squareRow(pawn) + 1 &&
+         std::abs(squareCol(square) - squareCol(pawn)) == 1;
+}
+
+struct Position {
+  bool whiteToMove;
+  int whiteKing, blackKing, pawn;
+  Result result;
+};
+
+Result initialResult(bool whiteToMove, int whiteKing, int blackKing,
+                     int pawn) {
+  if (distance(whiteKing, blackKing) <= 1 || whiteKing == pawn ||
+      blackKing == pawn || (whiteToMove && pawnAttacks(pawn, blackKing)))
+    return INVALID;
+
+  const int promotion = pawn + BOARD_SIZE;
+  // The pawn promotes safely: the queening square is free and either out of
+  // the defender's reach or covered by the attacking king.
+  if (whiteToMove && squareRow(pawn) == BOARD_SIZE - 2 &&
+      whiteKing != promotion && blackKing != promotion &&
+      (distance(blackKing, promotion) > 1 ||
+       distance(whiteKing, promotion) == 1))
+    return WIN;
+
+  if (!whiteToMove) {
+    bool canMove = false;
+    for (int to = 0; to < 64; ++to) {
+      if (distance(blackKing, to) != 1 || distance(whiteKing, to) <= 1 ||
+          pawnAttacks(pawn, to))
+        continue;
+      canMove = true;
+      // Capturing an undefended pawn leaves a bare-king draw.
+      if (to == pawn)
+        return DRAW;
+    }
+    if (!canMove)
+      return DRAW; // Stalemate
+  }
+  return UNKNOWN;
+}
+
+// Combine the results of all successors: the side to move picks its best.
+Result classify(const Position &pos, const std::vector<uint8_t> &table) {
+  const Result good = pos.whiteToMove ? WIN : DRAW;
+  const Result bad = pos.whiteToMove ? DRAW : WIN;
+  const int us = pos.whiteToMove ? pos.whiteKing : pos.blackKing;
+  const int them = pos.whiteToMove ? pos.blackKing : pos.whiteKing;
+
+  int results = INVALID;
+  for (int to = 0; to < 64; ++to) {
+    if (distance(us, to) != 1 || distance(them, to) <= 1)
+      continue;
+    results |= pos.whiteToMove
+                   ? table[index(false, pos.blackKing, to, pos.pawn)]
+                   : table[index(true, to, pos.whiteKing, pos.pawn)];
+  }
+
+  if (pos.whiteToMove && squareRow(pos.pawn) < BOARD_SIZE - 2) {
+    int push = pos.pawn + BOARD_SIZE;
+    if (push != pos.whiteKing && push != pos.blackKing) {
+      results |= table[index(false, pos.blackKing, pos.whiteKing, push)];
+      int doublePush = push + BOARD_SIZE;
+      if (squareRow(pos.pawn) == 1 && doublePush != pos.whiteKing &&
+          doublePush != pos.blackKing)
+        results |=
+            table[index(false, pos.blackKing, pos.whiteKing, doublePush)];
+    }
+  }
+
+  if (results & good)
+    return good;
+  if (results & UNKNOWN)
+    return UNKNOWN;
+  return bad;
+}
+
+std::vector<uint8_t> buildKPK() {
+  std::vector<uint8_t> table(MAX_INDEX, INVALID);
+  std::vector<Position> unknown;
+  for (int i = 0; i < MAX_INDEX; ++i) {
+    bool whiteToMove = ((i >> 12) & 1) == 0;
+    int whiteKing = i & 63, blackKing = (i >> 6) & 63;
+    int pawn = (6 - (i >> 15)) * BOARD_SIZE + ((i >> 13) & 3);
+    Result result = initialResult(whiteToMove, whiteKing, blackKing, pawn);
+    table[i] = result;
+    if (result == UNKNOWN)
+      unknown.push_back({whiteToMove, whiteKing, blackKing, pawn, UNKNOWN});
+  }
+
+  // Propagate until nothing changes; whatever is left unresolved cannot be
+  // forced to a win and is a draw.
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (Position &pos : unknown) {
+      if (pos.result != UNKNOWN)
+        continue;
+      pos.result = classify(pos, table);
+      if (pos.result != UNKNOWN) {
+        table[index(pos.whiteToMove, pos.blackKing, pos.whiteKing,
+                    pos.pawn)] = pos.result;
+        changed = true;
+      }
+    }
+  }
+  return table;
+}
+
+} // namespace
+
+bool probeKPK(int strongKing, int strongPawn, int weakKing,
+              bool strongToMove) {
+  static const std::vector<uint8_t> TABLE = buildKPK();
+  // Mirror onto files a-d, the only ones stored.
+  if (squareCol(strongPawn) >= BOARD_SIZE / 2) {
+    auto mirror = [](int square) {
+      return square - squareCol(square) + (BOARD_SIZE - 1 - squareCol(square));
+    };
+    strongKing = mirror(strongKing);
+    strongPawn = mirror(strongPawn);
+    weakKing = mirror(weakKing);
+  }
+  return TABLE[index(strongToMove, weakKing, strongKing, strongPawn)] == WIN;
+}
+
+} // namespace bitbase
+} // namespace chess
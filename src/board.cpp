@@ -1,8 +1,153 @@
 #include "board.hpp"
+#include "psqt.hpp"
+#include "zobrist.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
 namespace chess {
 
+namespace {
+
+// Rights that survive a move touching the given square.
+constexpr std::array<int, BOARD_SIZE * BOARD_SIZE> makeCastlingMasks() {
+  std::array<int, BOARD_SIZE * BOARD_SIZE> masks{};
+  for (auto &mask : masks)
+    mask = ALL_CASTLING;
+  masks[0] &= ~WHITE_QUEENSIDE;                     // a1
+  masks[4] &= ~(WHITE_KINGSIDE | WHITE_QUEENSIDE);  // e1
+  masks[7] &= ~WHITE_KINGSIDE;                      // h1
+  masks[56] &= ~BLACK_QUEENSIDE;                    // a8
+  masks[60] &= ~(BLACK_KINGSIDE | BLACK_QUEENSIDE); // e8
+  masks[63] &= ~BLACK_KINGSIDE;                     // h8
+  return masks;
+}
+
+constexpr std::array<int, BOARD_SIZE * BOARD_SIZE> CASTLING_MASKS =
+    makeCastlingMasks();
+
+constexpr int KNIGHT_OFFSETS[8][2] = {{-2, -1}, {-2, 1}, {-1, -2}, {-1, 2},
+                                      {1, -2},  {1, 2},  {2, -1},  {2, 1}};
+constexpr int KING_OFFSETS[8][2] = {{-1, -1}, {-1, 0}, {-1, 1}, {0, -1},
+                                    {0, 1},   {1, -1}, {1, 0},  {1, 1}};
+constexpr int DIAGONALS[4][2] = {{-1, -1}, {-1, 1}, {1, -1}, {1, 1}};
+constexpr int ORTHOGONALS[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+bool onBoard(int row, int col) {
+  return row >= 0 && row < BOARD_SIZE && col >= 0 && col < BOARD_SIZE;
+}
+
+constexpr char PIECE_LETTERS[] = ".pnbrqk"; // Indexed by PieceType
+constexpr char CASTLING_LETTERS[] = "KQkq";  // In CastlingRight bit order
+constexpr int MAX_CLOCK_DIGITS = 5;
+
+// Removes and returns the next space-separated field, empty at the end.
+std::string_view nextField(std::string_view &text) {
+  size_t start = text.find_first_not_of(' ');
+  if (start == std::string_view::npos) {
+    text = {};
+    return {};
+  }
+  text.remove_prefix(start);
+  std::string_view field = text.substr(0, text.find(' '));
+  text.remove_prefix(field.size());
+  return field;
+}
+
+// Unsigned decimal; from_chars alone would accept a minus sign.
+bool parseClock(std::string_view field, int &value) {
+  if (field.empty() || field.size() > MAX_CLOCK_DIGITS || field[0] == '-')
+    return false;
+  auto [end, error] =
+      std::from_chars(field.data(), field.data() + field.size(), value);
+  return error == std::errc() && end == field.data() + field.size();
+}
+
+// Piece placement, rank 8 first. Each rank must cover exactly eight files.
+bool parsePlacement(Board &board, std::string_view placement) {
+  int row = BOARD_SIZE - 1, col = 0;
+  bool previousDigit = false;
+  for (char c : placement) {
+    if (c == '/') {
+      if (col != BOARD_SIZE || row == 0)
+        return false;
+      --row;
+      col = 0;
+      previousDigit = false;
+      continue;
+    }
+    if (c >= '1' && c <= '8') {
+      if (previousDigit)
+        return false;
+      col += c - '0';
+      previousDigit = true;
+    } else {
+      const char lower = static_cast<char>(c | 0x20);
+      const char *letter = std::strchr(PIECE_LETTERS + 1, lower);
+      if (!letter || col >= BOARD_SIZE)
+        return false;
+      const PieceType type = static_cast<PieceType>(letter - PIECE_LETTERS);
+      if (type == PieceType::PAWN && (row == 0 || row == BOARD_SIZE - 1))
+        return false;
+      board.setPiece(row, col++,
+                     Piece(type, c == lower ? Color::BLACK : Color::WHITE));
+      previousDigit = false;
+    }
+    if (col > BOARD_SIZE)
+      return false;
+  }
+  return row == 0 && col == BOARD_SIZE;
+}
+
+// Castling rights in KQkq order, or -1. Every right needs its king and rook
+// on their original squares.
+int parseCastling(const Board &board, std::string_view field) {
+  if (field == "-")
+    return NO_CASTLING;
+  int rights = NO_CASTLING;
+  int next = 0;
+  for (char c : field) {
+    const char *letter = std::strchr(CASTLING_LETTERS + next, c);
+    if (!letter || c == '\0')
+      return -1;
+    next = static_cast<int>(letter - CASTLING_LETTERS);
+    const Color color = next < 2 ? Color::WHITE : Color::BLACK;
+    const int row = color == Color::WHITE ? 0 : BOARD_SIZE - 1;
+    const Piece &king = board.getPiece(row, 4);
+    const Piece &rook = board.getPiece(row, next % 2 == 0 ? 7 : 0);
+    if (king.getType() != PieceType::KING || king.getColor() != color ||
+        rook.getType() != PieceType::ROOK || rook.getColor() != color)
+      return -1;
+    rights |= 1 << next++;
+  }
+  return field.empty() ? -1 : rights;
+}
+
+// File of the en passant target, or -1. The target must lie behind a pawn
+// that just made a double step, with both squares it crossed empty.
+int parseEnPassant(const Board &board, std::string_view field) {
+  if (field == "-")
+    return -1;
+  const Color us = board.getSideToMove();
+  const char rank = us == Color::WHITE ? '6' : '3';
+  if (field.size() != 2 || field[0] < 'a' || field[0] > 'h' ||
+      field[1] != rank)
+    return -2;
+  const int col = field[0] - 'a';
+  const int target = rank - '1';
+  const int forward = us == Color::WHITE ? 1 : -1;
+  const Piece &pawn = board.getPiece(target - forward, col);
+  if (pawn.getType() != PieceType::PAWN || pawn.getColor() == us ||
+      !board.getPiece(target, col).isEmpty() ||
+      !board.getPiece(target + forward, col).isEmpty())
+    return -2;
+  return col;
+}
+
+} // namespace
+
 Board::Board() {
   clear(); // Start with an empty board
 
@@ -31,6 +176,85 @@ Board::Board() {
   setPiece(7, 5, Piece(PieceType::BISHOP, Color::BLACK));
   setPiece(7, 6, Piece(PieceType::KNIGHT, Color::BLACK));
   setPiece(7, 7, Piece(PieceType::ROOK, Color::BLACK));
+
+  setCastlingRights(ALL_CASTLING);
+}
+
+bool Board::fromFEN(std::string_view fen) {
+  clear();
+  const std::string_view placement = nextField(fen);
+  const std::string_view side = nextField(fen);
+  const std::string_view castling = nextField(fen);
+  const std::string_view enPassant = nextField(fen);
+  const std::string_view halfmoveClock = nextField(fen);
+  const std::string_view fullmoveNumber = nextField(fen);
+
+  bool valid = parsePlacement(*this, placement) &&
+               pieceCount_[0][static_cast<int>(PieceType::KING)] == 1 &&
+               pieceCount_[1][static_cast<int>(PieceType::KING)] == 1 &&
+               (side == "w" || side == "b") && nextField(fen).empty();
+  if (valid) {
+    setSideToMove(side == "w" ? Color::WHITE : Color::BLACK);
+    const int rights = parseCastling(*this, castling);
+    const int col = parseEnPassant(*this, enPassant);
+    valid = rights >= 0 && col >= -1 && !isInCheck(opposite(sideToMove_));
+    if (valid) {
+      setCastlingRights(rights);
+      setEnPassantCol(col);
+    }
+  }
+  if (valid && !halfmoveClock.empty())
+    valid = parseClock(halfmoveClock, halfmoveClock_) &&
+            parseClock(fullmoveNumber, fullmoveNumber_) &&
+            fullmoveNumber_ >= 1;
+  if (!valid)
+    clear();
+  return valid;
+}
+
+std::string Board::toFEN() const {
+  std::string fen;
+  fen.reserve(96); // Enough for any position, so the only allocation
+  for (int row = BOARD_SIZE - 1; row >= 0; --row) {
+    int empty = 0;
+    for (int col = 0; col < BOARD_SIZE; ++col) {
+      const Piece &piece = squares_[row][col];
+      if (piece.isEmpty()) {
+        ++empty;
+        continue;
+      }
+      if (empty)
+        fen += static_cast<char>('0' + empty);
+      empty = 0;
+      const char letter = PIECE_LETTERS[static_cast<int>(piece.getType())];
+      fen += piece.getColor() == Color::WHITE
+                 ? static_cast<char>(letter - 'a' + 'A')
+                 : letter;
+    }
+    if (empty)
+      fen += static_cast<char>('0' + empty);
+    if (row > 0)
+      fen += '/';
+  }
+
+  fen += sideToMove_ == Color::WHITE ? " w " : " b ";
+  if (castlingRights_ == NO_CASTLING)
+    fen += '-';
+  for (int i = 0; i < 4; ++i)
+    if (castlingRights_ & (1 << i))
+      fen += CASTLING_LETTERS[i];
+  fen += ' ';
+  if (enPassantCol_ < 0) {
+    fen += '-';
+  } else {
+    fen += static_cast<char>('a' + enPassantCol_);
+    fen += sideToMove_ == Color::WHITE ? '6' : '3';
+  }
+  fen += ' ';
+  fen += std::to_string(halfmoveClock_); // Short enough to stay inline
+  fen += ' ';
+  fen += std::to_string(fullmoveNumber_);
+  return fen;
 }
 
 const Piece &Board::getPiece(int row, int col) const {
@@ -38,18 +262,295 @@ const Piece &Board::getPiece(int row, int col) const {
 }
 
 void Board::setPiece(int row, int col, const Piece &piece) {
+  const Piece &old = squares_[row][col];
+  int square = row * BOARD_SIZE + col;
+  hash_ ^= zobrist::pieceKey(old.getColor(), old.getType(), row, col);
+  hash_ ^= zobrist::pieceKey(piece.getColor(), piece.getType(), row, col);
+  if (old.getType() == PieceType::PAWN)
+    pawnKey_ ^= zobrist::pieceKey(old.getColor(), PieceType::PAWN, row, col);
+  if (piece.getType() == PieceType::PAWN)
+    pawnKey_ ^= zobrist::pieceKey(piece.getColor(), PieceType::PAWN, row, col);
+  if (old.getType() == PieceType::KING &&
+      kingSquare_[static_cast<int>(old.getColor())] == square)
+    kingSquare_[static_cast<int>(old.getColor())] = -1;
+  if (piece.getType() == PieceType::KING)
+    kingSquare_[static_cast<int>(piece.getColor())] = square;
+  if (!old.isEmpty()) {
+    const psqt::Score &score =
+        psqt::score(old.getColor(), old.getType(), row, col);
+    midgameScore_ -= score.mg;
+    endgameScore_ -= score.eg;
+    pieces_[static_cast<int>(old.getColor())]
+           [static_cast<int>(old.getType())] &= ~squareBit(row, col);
+    int &count = pieceCount_[static_cast<int>(old.getColor())]
+                            [static_cast<int>(old.getType())];
+    materialKey_ ^=
+        zobrist::materialKey(old.getColor(), old.getType(), --count);
+  }
+  if (!piece.isEmpty()) {
+    const psqt::Score &score =
+        psqt::score(piece.getColor(), piece.getType(), row, col);
+    midgameScore_ += score.mg;
+    endgameScore_ += score.eg;
+    pieces_[static_cast<int>(piece.getColor())]
+           [static_cast<int>(piece.getType())] |= squareBit(row, col);
+    int &count = pieceCount_[static_cast<int>(piece.getColor())]
+                            [static_cast<int>(piece.getType())];
+    materialKey_ ^=
+        zobrist::materialKey(piece.getColor(), piece.getType(), count++);
+  }
   squares_[row][col] = piece;
 }
 
 void Board::clear() {
-  for (int row = 0; row < BOARD_SIZE; ++row) {
-    for (int col = 0; col < BOARD_SIZE; ++col) {
-      squares_[row][col] =
-          Piece(); // Default constructor creates an empty piece
+  const Piece empty; // Default constructor creates an empty piece
+  for (auto &rank : squares_)
+    rank.fill(empty);
+  hash_ = 0;
+  pawnKey_ = 0;
+  materialKey_ = 0;
+  sideToMove_ = Color::WHITE;
+  castlingRights_ = NO_CASTLING;
+  enPassantCol_ = -1;
+  halfmoveClock_ = 0;
+  fullmoveNumber_ = 1;
+  kingSquare_ = {-1, -1};
+  pieceCount_ = {};
+  pieces_ = {};
+  midgameScore_ = 0;
+  endgameScore_ = 0;
+  history_.clear();
+  history_.reserve(1024); // Keeps makeMove allocation-free during search
+}
+
+uint64_t Board::getHash() const { return hash_; }
+
+uint64_t Board::getPawnKey() const { return pawnKey_; }
+
+uint64_t Board::getMaterialKey() const { return materialKey_; }
+
+Color Board::getSideToMove() const { return sideToMove_; }
+
+void Board::setSideToMove(Color color) {
+  if (color != sideToMove_)
+    hash_ ^= zobrist::KEYS.side;
+  sideToMove_ = color;
+}
+
+int Board::getCastlingRights() const { return castlingRights_; }
+
+void Board::setCastlingRights(int rights) {
+  hash_ ^= zobrist::KEYS.castling[castlingRights_];
+  castlingRights_ = rights & ALL_CASTLING;
+  hash_ ^= zobrist::KEYS.castling[castlingRights_];
+}
+
+int Board::getEnPassantCol() const { return enPassantCol_; }
+
+void Board::setEnPassantCol(int col) {
+  if (enPassantCol_ >= 0)
+    hash_ ^= zobrist::KEYS.enPassant[enPassantCol_];
+  enPassantCol_ = col;
+  if (enPassantCol_ >= 0)
+    hash_ ^= zobrist::KEYS.enPassant[enPassantCol_];
+}
+
+int Board::getHalfmoveClock() const { return halfmoveClock_; }
+
+int Board::getFullmoveNumber() const { return fullmoveNumber_; }
+
+void Board::makeMove(const Move &move) {
+  const Piece moving = squares_[move.startRow][move.startCol];
+  const Color us = moving.getColor();
+  StateInfo state{squares_[move.endRow][move.endCol], false, castlingRights_,
+                  enPassantCol_, halfmoveClock_, hash_, {}};
+  const int from = move.startRow * BOARD_SIZE + move.startCol;
+  const int to = move.endRow * BOARD_SIZE + move.endCol;
+  DirtyPieces &dirty = state.dirty;
+
+  if (moving.getType() == PieceType::PAWN && move.startCol != move.endCol &&
+      state.captured.isEmpty()) {
+    state.enPassant = true;
+    state.captured = squares_[move.startRow][move.endCol];
+    setPiece(move.startRow, move.endCol, Piece());
+    dirty.pieces[dirty.count++] = {
+        state.captured,
+        static_cast<int8_t>(move.startRow * BOARD_SIZE + move.endCol), -1};
+  } else if (!state.captured.isEmpty()) {
+    dirty.pieces[dirty.count++] = {state.captured, static_cast<int8_t>(to),
+                                   -1};
+  }
+  if (move.promotionType == PieceType::NONE) {
+    dirty.pieces[dirty.count++] = {moving, static_cast<int8_t>(from),
+                                   static_cast<int8_t>(to)};
+  } else {
+    dirty.pieces[dirty.count++] = {moving, static_cast<int8_t>(from), -1};
+    dirty.pieces[dirty.count++] = {Piece(move.promotionType, us), -1,
+                                   static_cast<int8_t>(to)};
+  }
+
+  setEnPassantCol(-1);
+  setPiece(move.endRow, move.endCol,
+           move.promotionType == PieceType::NONE
+               ? moving
+               : Piece(move.promotionType, us));
+  setPiece(move.startRow, move.startCol, Piece());
+
+  if (moving.getType() == PieceType::KING &&
+      std::abs(move.endCol - move.startCol) == 2) {
+    int rookFrom = move.endCol > move.startCol ? BOARD_SIZE - 1 : 0;
+    int rookTo = (move.startCol + move.endCol) / 2;
+    dirty.pieces[dirty.count++] = {
+        squares_[move.startRow][rookFrom],
+        static_cast<int8_t>(move.startRow * BOARD_SIZE + rookFrom),
+        static_cast<int8_t>(move.startRow * BOARD_SIZE + rookTo)};
+    setPiece(move.startRow, rookTo, squares_[move.startRow][rookFrom]);
+    setPiece(move.startRow, rookFrom, Piece());
+  }
+  history_.push_back(state);
+
+  if (moving.getType() == PieceType::PAWN &&
+      std::abs(move.endRow - move.startRow) == 2)
+    setEnPassantCol(move.startCol);
+
+  setCastlingRights(castlingRights_ &
+                    CASTLING_MASKS[move.startRow * BOARD_SIZE + move.startCol] &
+                    CASTLING_MASKS[move.endRow * BOARD_SIZE + move.endCol]);
+
+  if (moving.getType() == PieceType::PAWN || !state.captured.isEmpty())
+    halfmoveClock_ = 0;
+  else
+    ++halfmoveClock_;
+  if (us == Color::BLACK)
+    ++fullmoveNumber_;
+  setSideToMove(opposite(us));
+}
+
+void Board::unmakeMove(const Move &move) {
+  const StateInfo state = history_.back();
+  history_.pop_back();
+
+  const Piece moved = squares_[move.endRow][move.endCol];
+  const Color us = moved.getColor();
+
+  setPiece(move.startRow, move.startCol,
+           move.promotionType == PieceType::NONE ? moved
+                                                 : Piece(PieceType::PAWN, us));
+  if (state.enPassant) {
+    setPiece(move.endRow, move.endCol, Piece());
+    setPiece(move.startRow, move.endCol, state.captured);
+  } else {
+    setPiece(move.endRow, move.endCol, state.captured);
+  }
+
+  if (moved.getType() == PieceType::KING &&
+      std::abs(move.endCol - move.startCol) == 2) {
+    int rookFrom = move.endCol > move.startCol ? BOARD_SIZE - 1 : 0;
+    int rookTo = (move.startCol + move.endCol) / 2;
+    setPiece(move.startRow, rookFrom, squares_[move.startRow][rookTo]);
+    setPiece(move.startRow, rookTo, Piece());
+  }
+
+  if (us == Color::BLACK)
+    --fullmoveNumber_;
+  sideToMove_ = us;
+  castlingRights_ = state.castlingRights;
+  enPassantCol_ = state.enPassantCol;
+  halfmoveClock_ = state.halfmoveClock;
+  hash_ = state.hash;
+}
+
+void Board::makeNullMove() {
+  history_.push_back({Piece(), false, castlingRights_, enPassantCol_,
+                      halfmoveClock_, hash_, {}});
+  setEnPassantCol(-1);
+  // Restart the clock so repetition checks do not look across the null move.
+  halfmoveClock_ = 0;
+  setSideToMove(opposite(sideToMove_));
+}
+
+void Board::unmakeNullMove() {
+  const StateInfo state = history_.back();
+  history_.pop_back();
+  sideToMove_ = opposite(sideToMove_);
+  enPassantCol_ = state.enPassantCol;
+  halfmoveClock_ = state.halfmoveClock;
+  hash_ = state.hash;
+}
+
+bool Board::isSquareAttacked(int row, int col, Color byColor) const {
+  // Pawns of byColor attack from the rank behind the target.
+  int pawnRow = byColor == Color::WHITE ? row - 1 : row + 1;
+  for (int dc : {-1, 1}) {
+    if (!onBoard(pawnRow, col + dc))
+      continue;
+    const Piece &piece = squares_[pawnRow][col + dc];
+    if (piece.getType() == PieceType::PAWN && piece.getColor() == byColor)
+      return true;
+  }
+
+  for (const auto &offset : KNIGHT_OFFSETS) {
+    int r = row + offset[0], c = col + offset[1];
+    if (onBoard(r, c) && squares_[r][c].getType() == PieceType::KNIGHT &&
+        squares_[r][c].getColor() == byColor)
+      return true;
+  }
+
+  for (const auto &offset : KING_OFFSETS) {
+    int r = row + offset[0], c = col + offset[1];
+    if (onBoard(r, c) && squares_[r][c].getType() == PieceType::KING &&
+        squares_[r][c].getColor() == byColor)
+      return true;
+  }
+
+  for (const auto &dir : DIAGONALS) {
+    for (int r = row + dir[0], c = col + dir[1]; onBoard(r, c);
+         r += dir[0], c += dir[1]) {
+      const Piece &piece = squares_[r][c];
+      if (piece.isEmpty())
+        continue;
+      if (piece.getColor() == byColor &&
+          (piece.getType() == PieceType::BISHOP ||
+           piece.getType() == PieceType::QUEEN))
+        return true;
+      break;
     }
   }
+
+  for (const auto &dir : ORTHOGONALS) {
+    for (int r = row + dir[0], c = col + dir[1]; onBoard(r, c);
+         r += dir[0], c += dir[1]) {
+      const Piece &piece = squares_[r][c];
+      if (piece.isEmpty())
+        continue;
+      if (piece.getColor() == byColor &&
+          (piece.getType() == PieceType::ROOK ||
+           piece.getType() == PieceType::QUEEN))
+        return true;
+      break;
+    }
+  }
+  return false;
+}
+
+bool Board::isInCheck(Color color) const {
+  int square = kingSquare_[static_cast<int>(color)];
+  return square >= 0 && isSquareAttacked(square / BOARD_SIZE,
+                                          square % BOARD_SIZE,
+                                          opposite(color));
+}
+
+bool Board::isRepetition() const {
+  int size = static_cast<int>(history_.size());
+  int earliest = std::max(0, size - halfmoveClock_);
+  for (int i = size - 4; i >= earliest; i -= 2)
+    if (history_[i].hash == hash_)
+      return true;
+  return false;
 }
 
+bool Board::isDraw() const { return halfmoveClock_ >= 100 || isRepetition(); }
+
 void Board::printBoard() const {
   for (int row = BOARD_SIZE - 1; row >= 0; --row) {
     for (int col = 0; col < BOARD_SIZE; ++col) {
@@ -91,4 +592,52 @@ void Board::printBoard() const {
   std::cout << std::endl;
 }
 
+int Board::getPieceCount(Color color, PieceType type) const {
+  return pieceCount_[static_cast<int>(color)][static_cast<int>(type)];
+}
+
+bool Board::hasNonPawnMaterial(Color color) const {
+  const auto &counts = pieceCount_[static_cast<int>(color)];
+  return counts[static_cast<int>(PieceType::KNIGHT)] +
+             counts[static_cast<int>(PieceType::BISHOP)] +
+             counts[static_cast<int>(PieceType::ROOK)] +
+             counts[static_cast<int>(PieceType::QUEEN)] >
+         0;
+}
+
+Bitboard Board::getPieces(Color color, PieceType type) const {
+  return pieces_[static_cast<int>(color)][static_cast<int>(type)];
+}
+
+Bitboard Board::getPawns(Color color) const {
+  return getPieces(color, PieceType::PAWN);
+}
+
+Bitboard Board::getOccupied(Color color) const {
+  const auto &pieces = pieces_[static_cast<int>(color)];
+  return pieces[1] | pieces[2] | pieces[3] | pieces[4] | pieces[5] |
+         pieces[6];
+}
+
+int Board::getKingSquare(Color color) const {
+  return kingSquare_[static_cast<int>(color)];
+}
+
+int Board::getHistorySize() const {
+  return static_cast<int>(history_.size());
+}
+
+uint64_t Board::getHistoryHash(int index) const {
+  return index == static_cast<int>(history_.size()) ? hash_
+                                                    : history_[index].hash;
+}
+
+const DirtyPieces &Board::getDirtyPieces(int index) const {
+  return history_[index].dirty;
+}
+
+int Board::getMidgameScore() const { return midgameScore_; }
+
+int Board::getEndgameScore() const { return endgameScore_; }
+
 } // namespace chess
@@ -0,0 +1,231 @@
+#include "book_builder.hpp"
+#include "book.hpp"
+#include "pgn.hpp"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace chess {
+
+namespace {
+
+constexpr int SHARD_BITS = 6;
+constexpr int SHARD_COUNT = 1 << SHARD_BITS;
+constexpr int PARTS_PER_THREAD = 4; // Evens out parts of unequal speed
+constexpr uint32_t MAX_WEIGHT = 0xFFFF;
+constexpr size_t ENTRY_SIZE = 16;
+
+struct EntryKey {
+  uint64_t key;
+  uint16_t move;
+
+  bool operator==(const EntryKey &other) const {
+    return key == other.key && move == other.move;
+  }
+};
+
+struct EntryKeyHash {
+  size_t operator()(const EntryKey &entry) const {
+    return static_cast<size_t>(entry.key ^
+                               entry.move * 0x9E3779B97F4A7C15ULL);
+  }
+};
+
+// From the point of view of the side that played the move.
+struct Results {
+  uint32_t wins = 0;
+  uint32_t draws = 0;
+  uint32_t losses = 0;
+};
+
+using Shard = std::unordered_map<EntryKey, Results, EntryKeyHash>;
+
+struct BookEntry {
+  uint64_t key;
+  uint16_t move;
+  uint32_t weight;
+};
+
+int shardOf(uint64_t key) {
+  return static_cast<int>(key >> (64 - SHARD_BITS));
+}
+
+// White's score of a finished game: 1, 0 or -1.
+bool parseResult(std::string_view result, int &score) {
+  if (result == "1-0")
+    score = 1;
+  else if (result == "0-1")
+    score = -1;
+  else if (result == "1/2-1/2")
+    score = 0;
+  else
+    return false;
+  return true;
+}
+
+void writeBigEndian(std::string &out, uint64_t value, int bytes) {
+  for (int byte = bytes - 1; byte >= 0; --byte)
+    out += static_cast<char>(value >> (8 * byte) & 0xFF);
+}
+
+// One shard of every worker, merged into sorted, weighted entries.
+std::vector<BookEntry> mergeShard(std::vector<std::vector<Shard>> &shards,
+                                  int index, uint32_t minGames) {
+  Shard merged = std::move(shards[0][index]);
+  for (size_t worker = 1; worker < shards.size(); ++worker) {
+    for (const auto &[key, results] : shards[worker][index]) {
+      Results &total = merged[key];
+      total.wins += results.wins;
+      total.draws += results.draws;
+      total.losses += results.losses;
+    }
+    Shard().swap(shards[worker][index]);
+  }
+
+  std::vector<BookEntry> entries;
+  for (const auto &[key, results] : merged) {
+    const uint64_t games =
+        uint64_t(results.wins) + results.draws + results.losses;
+    const uint64_t points = 2 * uint64_t(results.wins) + results.draws;
+    if (games >= minGames && points > 0)
+      entries.push_back({key.key, key.move,
+                         static_cast<uint32_t>(std::min<uint64_t>(
+                             points, UINT32_MAX))});
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const BookEntry &a, const BookEntry &b) {
+              if (a.key != b.key)
+                return a.key < b.key;
+              return a.weight != b.weight ? a.weight > b.weight
+                                          : a.move < b.move;
+            });
+
+  // The heaviest move of each position sets the scale of its weights.
+  for (size_t first = 0; first < entries.size();) {
+    size_t last = first;
+    while (last < entries.size() && entries[last].key == entries[first].key)
+      ++last;
+    const uint64_t heaviest = entries[first].weight;
+    if (heaviest > MAX_WEIGHT)
+      for (size_t i = first; i < last; ++i)
+        entries[i].weight = static_cast<uint32_t>(
+            std::max<uint64_t>(uint64_t(entries[i].weight) * MAX_WEIGHT /
+                                   heaviest,
+                               1));
+    first = last;
+  }
+  return entries;
+}
+
+} // namespace
+
+BookBuilder::BookBuilder(int threads, int maxPly, uint32_t minGames)
+    : threads_(std::max(threads, 1)), maxPly_(std::max(maxPly, 1)),
+      minGames_(std::max<uint32_t>(minGames, 1)) {}
+
+bool BookBuilder::build(std::string_view pgn, const std::string &path,
+                        BookBuildReport &report) {
+  report = {};
+  const std::vector<std::string_view> parts =
+      splitPgn(pgn, threads_ * PARTS_PER_THREAD);
+  const int threads = std::max(
+      1, std::min<int>(threads_, static_cast<int>(parts.size())));
+  std::vector<std::vector<Shard>> shards(threads,
+                                         std::vector<Shard>(SHARD_COUNT));
+  std::vector<BookBuildReport> counts(threads);
+  std::atomic<size_t> nextPart{0};
+
+  // Runs work(worker) on every worker; the calling thread is worker 0.
+  auto runWorkers = [threads](const std::function<void(int)> &work) {
+    std::vector<std::thread> pool;
+    for (int worker = 1; worker < threads; ++worker)
+      pool.emplace_back(work, worker);
+    work(0);
+    for (std::thread &thread : pool)
+      thread.join();
+  };
+
+  auto count = [&](int worker) {
+    std::vector<Shard> &own = shards[worker];
+    BookBuildReport &counted = counts[worker];
+    struct Played {
+      EntryKey entry;
+      Color side;
+    };
+    std::vector<Played> line;
+    line.reserve(maxPly_);
+    Board board;
+    PgnGame game;
+    for (size_t part = nextPart++; part < parts.size(); part = nextPart++) {
+      PgnReader reader(parts[part]);
+      while (reader.next(game)) {
+        int score = 0;
+        line.clear();
+        // Moves are only counted once the whole game has been read.
+        if (!parseResult(game.tag("Result"), score) ||
+            !replayPgnGame(game, board,
+                           [&](const Board &position, const Move &move) {
+                             if (static_cast<int>(line.size()) >= maxPly_)
+                               return false;
+                             line.push_back(
+                                 {{bookKey(position),
+                                   encodeBookMove(position, move)},
+                                  position.getSideToMove()});
+                             return true;
+                           })) {
+          ++counted.skipped;
+          continue;
+        }
+        ++counted.games;
+        counted.moves += line.size();
+        for (const Played &played : line) {
+          Results &results = own[shardOf(played.entry.key)][played.entry];
+          const int mover = played.side == Color::WHITE ? score : -score;
+          ++(mover > 0 ? results.wins
+                       : mover < 0 ? results.losses : results.draws);
+        }
+      }
+    }
+  };
+
+  std::vector<std::string> output(SHARD_COUNT);
+  std::vector<uint64_t> written(SHARD_COUNT);
+  std::atomic<int> nextShard{0};
+  auto merge = [&](int) {
+    for (int index = nextShard++; index < SHARD_COUNT; index = nextShard++) {
+      const std::vector<BookEntry> entries =
+          mergeShard(shards, index, minGames_);
+      std::string &out = output[index];
+      out.reserve(entries.size() * ENTRY_SIZE);
+      for (const BookEntry &entry : entries) {
+        writeBigEndian(out, entry.key, 8);
+        writeBigEndian(out, entry.move, 2);
+        writeBigEndian(out, entry.weight, 2);
+        writeBigEndian(out, 0, 4); // Learning data, unused
+      }
+      written[index] = entries.size();
+    }
+  };
+
+  runWorkers(count);
+  runWorkers(merge);
+
+  for (const BookBuildReport &counted : counts) {
+    report.games += counted.games;
+    report.skipped += counted.skipped;
+    report.moves += counted.moves;
+  }
+  std::ofstream file(path, std::ios::binary);
+  for (int index = 0; index < SHARD_COUNT && file; ++index) {
+    file.write(output[index].data(),
+               static_cast<std::streamsize>(output[index].size()));
+    report.entries += written[index];
+  }
+  return static_cast<bool>(file);
+}
+
+} // namespace chess
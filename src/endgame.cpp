@@ -0,0 +1,115 @@
+#include "endgame.hpp"
+#include "bitbase.hpp"
+#include "evaluation.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+namespace chess {
+namespace endgame {
+
+namespace {
+
+int distance(int a, int b) {
+  return std::max(std::abs(a / BOARD_SIZE - b / BOARD_SIZE),
+                  std::abs(a % BOARD_SIZE - b % BOARD_SIZE));
+}
+
+// Larger towards the edges and corners: 20 in the centre, 140 in a corner.
+int pushToEdge(int square) {
+  return 10 * (std::abs(2 * (square / BOARD_SIZE) - 7) +
+               std::abs(2 * (square % BOARD_SIZE) - 7));
+}
+
+int pushClose(int a, int b) { return 140 - 20 * distance(a, b); }
+
+bool isDarkSquare(int square) {
+  return (square / BOARD_SIZE + square % BOARD_SIZE) % 2 == 0;
+}
+
+} // namespace
+
+int evaluateKXK(const Board &board, Color strong) {
+  const Color weak = opposite(strong);
+  const int strongKing = board.getKingSquare(strong);
+  const int weakKing = board.getKingSquare(weak);
+  int score = nonPawnMaterial(board, strong) +
+              board.getPieceCount(strong, PieceType::PAWN) *
+                  pieceValue(PieceType::PAWN) +
+              pushToEdge(weakKing) + pushClose(strongKing, weakKing);
+
+  if (board.getPieceCount(strong, PieceType::QUEEN) ||
+      board.getPieceCount(strong, PieceType::ROOK) ||
+      board.getPieceCount(strong, PieceType::BISHOP) >= 2 ||
+      (board.getPieceCount(strong, PieceType::BISHOP) &&
+       board.getPieceCount(strong, PieceType::KNIGHT)))
+    score = std::min(score + VALUE_KNOWN_WIN, VALUE_KNOWN_WIN * 2);
+  return score;
+}
+
+int evaluateKBNK(const Board &board, Color strong) {
+  const Color weak = opposite(strong);
+  const int strongKing = board.getKingSquare(strong);
+  const int weakKing = board.getKingSquare(weak);
+  // Mate is only possible in a corner of the bishop's colour; mirror a
+  // light-squared bishop's case onto the dark corners a1 and h8.
+  int corner = weakKing;
+  if (!isDarkSquare(lsb(board.getPieces(strong, PieceType::BISHOP))))
+    corner ^= BOARD_SIZE - 1;
+  int row = corner / BOARD_SIZE, col = corner % BOARD_SIZE;
+  int pushToCorner = 60 * std::abs(7 - row - col);
+  return VALUE_KNOWN_WIN + pieceValue(PieceType::BISHOP) +
+         pieceValue(PieceType::KNIGHT) + pushToCorner +
+         pushClose(strongKing, weakKing);
+}
+
+int evaluateKPK(const Board &board, Color strong) {
+  int strongKing = board.getKingSquare(strong);
+  int weakKing = board.getKingSquare(opposite(strong));
+  int pawn = lsb(board.getPawns(strong));
+  // The bitbase is stored for a White pawn; flip ranks for Black.
+  if (strong == Color::BLACK) {
+    strongKing ^= 56;
+    weakKing ^= 56;
+    pawn ^= 56;
+  }
+  if (!bitbase::probeKPK(strongKing, pawn, weakKing,
+                         board.getSideToMove() == strong))
+    return 0;
+  return VALUE_KNOWN_WIN + pieceValue(PieceType::PAWN) +
+         10 * (pawn / BOARD_SIZE);
+}
+
+int evaluateKNNK(const Board &, Color) { return 0; }
+
+int scaleKBPsK(const Board &board, Color strong) {
+  const Bitboard pawns = board.getPawns(strong);
+  const bool aFile = !(pawns & ~fileMask(0));
+  const bool hFile = !(pawns & ~fileMask(BOARD_SIZE - 1));
+  if (!pawns || (!aFile && !hFile))
+    return SCALE_NONE;
+
+  // A rook pawn whose queening square the bishop cannot cover is a draw
+  // once the defending king reaches the corner.
+  const int queeningRow = strong == Color::WHITE ? BOARD_SIZE - 1 : 0;
+  const int queeningSquare =
+      queeningRow * BOARD_SIZE + (aFile ? 0 : BOARD_SIZE - 1);
+  const int bishop = lsb(board.getPieces(strong, PieceType::BISHOP));
+  if (isDarkSquare(bishop) != isDarkSquare(queeningSquare) &&
+      distance(queeningSquare, board.getKingSquare(opposite(strong))) <= 1)
+    return SCALE_DRAW;
+  return SCALE_NONE;
+}
+
+int scaleOppositeBishops(const Board &board, Color strong) {
+  const int ours = lsb(board.getPieces(strong, PieceType::BISHOP));
+  const int theirs = lsb(board.getPieces(opposite(strong), PieceType::BISHOP));
+  if (isDarkSquare(ours) == isDarkSquare(theirs))
+    return SCALE_NONE;
+  // Even two extra pawns are often not enough to win.
+  int extraPawns = board.getPieceCount(strong, PieceType::PAWN) -
+                   board.getPieceCount(opposite(strong), PieceType::PAWN);
+  return extraPawns <= 1 ? 16 : 32;
+}
+
+} // namespace endgame
+} // namespace chess
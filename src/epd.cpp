@@ -0,0 +1,136 @@
+#include "epd.hpp"
+#include "notation.hpp"
+#include "transposition_table.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace chess {
+
+namespace {
+
+// Removes and returns the next operand, a word or a quoted string.
+std::string_view nextOperand(std::string_view &text) {
+  size_t start = text.find_first_not_of(' ');
+  if (start == std::string_view::npos) {
+    text = {};
+    return {};
+  }
+  text.remove_prefix(start);
+  if (text.front() == '"') {
+    size_t end = text.find('"', 1);
+    std::string_view operand = text.substr(1, end - 1);
+    text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+    return operand;
+  }
+  std::string_view operand = text.substr(0, text.find(' '));
+  text.remove_prefix(operand.size());
+  return operand;
+}
+
+bool isSolved(const EpdPosition &position, const Move &move) {
+  auto contains = [&](const std::vector<Move> &moves) {
+    return std::find(moves.begin(), moves.end(), move) != moves.end();
+  };
+  return (position.bestMoves.empty() || contains(position.bestMoves)) &&
+         !contains(position.avoidMoves);
+}
+
+} // namespace
+
+bool parseEpd(std::string_view line, EpdPosition &position,
+              std::string &error) {
+  position = EpdPosition();
+  std::string_view rest = line;
+  for (int field = 0; field < 4; ++field) {
+    std::string_view value = nextOperand(rest);
+    if (value.empty()) {
+      error = "missing position fields";
+      return false;
+    }
+    position.fen.append(value).push_back(' ');
+  }
+  Board board;
+  if (!board.fromFEN(position.fen)) {
+    error = "invalid position";
+    return false;
+  }
+
+  // Operations: an opcode, its operands and a semicolon each.
+  while (!rest.empty()) {
+    size_t end = rest.find(';');
+    std::string_view operation = rest.substr(0, end);
+    rest.remove_prefix(end == std::string_view::npos ? rest.size() : end + 1);
+    std::string_view opcode = nextOperand(operation);
+    if (opcode == "id") {
+      position.id = std::string(nextOperand(operation));
+    } else if (opcode == "bm" || opcode == "am") {
+      auto &moves = opcode == "bm" ? position.bestMoves : position.avoidMoves;
+      for (std::string_view san = nextOperand(operation); !san.empty();
+           san = nextOperand(operation)) {
+        Move move = parseSanMove(board, san);
+        if (move == Move()) {
+          error = "illegal move " + std::string(san);
+          return false;
+        }
+        moves.push_back(move);
+      }
+    }
+  }
+  if (position.bestMoves.empty() && position.avoidMoves.empty()) {
+    error = "no bm or am operation";
+    return false;
+  }
+  return true;
+}
+
+EpdRunner::EpdRunner(int threads, size_t hashMegabytes)
+    : threads_(std::max(threads, 1)), hashMegabytes_(hashMegabytes) {}
+
+EpdReport EpdRunner::run(const std::vector<EpdPosition> &positions,
+                         const SearchLimits &limits,
+                         const ResultCallback &onResult) {
+  const auto start = std::chrono::steady_clock::now();
+  EpdReport report;
+  report.total = static_cast<int>(positions.size());
+  std::atomic<size_t> next{0};
+  std::mutex reportMutex;
+
+  auto worker = [&] {
+    TranspositionTable tt(hashMegabytes_);
+    auto search = std::make_unique<Search>(tt);
+    Board board;
+    for (size_t i = next++; i < positions.size(); i = next++) {
+      const EpdPosition &position = positions[i];
+      board.fromFEN(position.fen);
+      tt.clear();
+      search->clear();
+      SearchResult result = search->think(board, limits);
+      bool solved = isSolved(position, result.bestMove);
+
+      std::lock_guard<std::mutex> lock(reportMutex);
+      report.solved += solved;
+      report.nodes += result.nodes;
+      if (onResult)
+        onResult(position, result, solved);
+    }
+  };
+
+  std::vector<std::thread> pool;
+  const int threads = std::min<int>(threads_, report.total);
+  for (int i = 1; i < threads; ++i)
+    pool.emplace_back(worker);
+  worker(); // The calling thread works too
+  for (std::thread &thread : pool)
+    thread.join();
+
+  report.time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+  return report;
+}
+
+} // namespace chess
@@ -0,0 +1,45 @@
+#include "eval_cache.hpp"
+#include <algorithm>
+
+namespace chess {
+
+namespace {
+
+// The lowest bit is always set, so an empty slot never verifies.
+uint16_t checkOf(uint64_t key) {
+  return static_cast<uint16_t>(key >> 48) | 1;
+}
+
+} // namespace
+
+EvalCache::EvalCache() : entries_(ENTRY_COUNT) {}
+
+bool EvalCache::probe(uint64_t key, int &eval) {
+  const Entry &entry = entries_[key & (ENTRY_COUNT - 1)];
+  if (entry.check != checkOf(key)) {
+    ++misses_;
+    return false;
+  }
+  ++hits_;
+  eval = entry.eval;
+  return true;
+}
+
+void EvalCache::store(uint64_t key, int eval) {
+  Entry &entry = entries_[key & (ENTRY_COUNT - 1)];
+  entry.check = checkOf(key);
+  entry.eval = static_cast<int16_t>(eval);
+}
+
+void EvalCache::clear() {
+  std::fill(entries_.begin(), entries_.end(), Entry());
+  resetCounters();
+}
+
+void EvalCache::resetCounters() { hits_ = misses_ = 0; }
+
+uint64_t EvalCache::getHits() const { return hits_; }
+
+uint64_t EvalCache::getMisses() const { return misses_; }
+
+} // namespace chess
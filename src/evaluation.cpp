@@ -0,0 +1,52 @@
+#include "evaluation.hpp"
+#include "psqt.hpp"
+
+namespace chess {
+
+int Evaluator::evaluate(const Board &board) {
+  int eval;
+  if (cache_.probe(board.getHash(), eval))
+    return eval;
+  eval = computeEvaluation(board);
+  cache_.store(board.getHash(), eval);
+  return eval;
+}
+
+int Evaluator::computeEvaluation(const Board &board) {
+  // Recognized endings have their own evaluation.
+  MaterialEntry &material = materialTable_.probe(board);
+  if (material.evaluation) {
+    int score = material.evaluation(board, material.strongSide);
+    return board.getSideToMove() == material.strongSide ? score : -score;
+  }
+  if (nnue::isLoaded())
+    return accumulators_.evaluate(board);
+
+  // Material and piece-square terms are maintained incrementally by the
+  // board and pawn structure comes from the pawn table, so only the taper
+  // between the two phases is computed here.
+  PawnEntry &pawns = pawnTable_.probe(board);
+  int mg = board.getMidgameScore() + material.midgameImbalance +
+           pawns.midgameScore + pawnTable_.shelter(pawns, board, Color::WHITE) -
+           pawnTable_.shelter(pawns, board, Color::BLACK);
+  int eg = board.getEndgameScore() + material.endgameImbalance +
+           pawns.endgameScore;
+  eg = eg * material.scale(board, eg > 0 ? Color::WHITE : Color::BLACK) /
+       endgame::SCALE_NORMAL;
+
+  int phase = material.phase;
+  int score = (mg * phase + eg * (psqt::MAX_PHASE - phase)) / psqt::MAX_PHASE;
+  return board.getSideToMove() == Color::WHITE ? score : -score;
+}
+
+void Evaluator::clear() {
+  cache_.clear();
+  pawnTable_.clear();
+  materialTable_.clear();
+}
+
+const EvalCache &Evaluator::getCache() const { return cache_; }
+
+void Evaluator::resetCacheCounters() { cache_.resetCounters(); }
+
+} // namespace chess
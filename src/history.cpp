@@ -0,0 +1,25 @@
+#include "history.hpp"
+
+namespace chess {
+
+void HistoryTables::clear() {
+  for (auto &from : butterfly)
+    for (auto &to : from)
+      to.fill(0);
+  for (auto &piece : continuation)
+    for (auto &context : piece)
+      for (auto &row : context)
+        row.fill(0);
+  clearKillers();
+}
+
+void HistoryTables::clearKillers() { killers.fill({Move(), Move()}); }
+
+void HistoryTables::storeKiller(int ply, const Move &move) {
+  if (killers[ply][0] != move) {
+    killers[ply][1] = killers[ply][0];
+    killers[ply][0] = move;
+  }
+}
+
+} // namespace chess
@@ -1,41 +1,30 @@
-#include "board.hpp"
-#include "move_generator.hpp"
+#include "nnue.hpp"
+#include "nnue_kernels.hpp"
+#include "uci.hpp"
 #include <SDL.h>
 #include <iostream>
 
 int main(int argc, char *argv[]) {
-
-  chess::Board board;
-  board.printBoard();
-
-  chess::MoveGenerator moveGen;
-  std::vector<chess::Move> whiteMoves =
-      moveGen.generateMoves(board, chess::Color::WHITE);
-
-  std::cout << "Generated move for White:\n";
-  for (const auto &move : whiteMoves) {
-    std::cout << "Start: (" << move.startRow << ", " << move.startCol
-              << ") End: (" << move.endRow << ", " << move.endCol << ")\n";
-  }
-
-  std::vector<chess::Move> blackMoves =
-      moveGen.generateMoves(board, chess::Color::BLACK);
-
-  std::cout << "\nGenerated move for White:\n";
-  for (const auto &move : blackMoves) {
-    std::cout << "Start: (" << move.startRow << ", " << move.startCol
-              << ") End: (" << move.endRow << ", " << move.endCol << ")\n";
-  }
-
-  // SDL
+  // SDL. Diagnostics go to stderr: stdout carries the UCI protocol.
   if (SDL_Init(SDL_INIT_VIDEO) < 0) {
-    std::cerr << "SDL Could not be initlaized! SDL_Error: " << SDL_GetError()
+    std::cerr << "SDL could not be initialized! SDL_Error: " << SDL_GetError()
               << std::endl;
     return 1;
   }
-  std::cout << "SDL initlaized successfully\n";
 
-  SDL_Delay(1000);
+  // Optional NNUE network; the classical evaluation is used without one.
+  // The EvalFile option can load one later.
+  if (argc > 1) {
+    if (chess::nnue::loadNetwork(argv[1]))
+      std::cout << "info string Loaded network " << argv[1] << " ("
+                << chess::nnue::activeKernels().name << " kernels)\n";
+    else
+      std::cerr << "Could not load network " << argv[1] << "\n";
+  }
+
+  chess::Uci uci(std::cin, std::cout);
+  std::cerr << uci.getHashTable().describe() << "\n";
+  uci.loop();
 
   SDL_Quit();
   return 0;
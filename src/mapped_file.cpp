@@ -0,0 +1,87 @@
+#include "mapped_file.hpp"
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CHESS_HAS_MMAP
+#endif
+
+namespace chess {
+
+MappedFile::~MappedFile() { close(); }
+
+bool MappedFile::open(const std::string &path, Access access) {
+  close();
+#ifdef CHESS_HAS_MMAP
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat status;
+  if (fstat(fd, &status) != 0) {
+    ::close(fd);
+    return false;
+  }
+  size_ = static_cast<size_t>(status.st_size);
+  if (size_ == 0) { // mmap rejects empty files
+    ::close(fd);
+    open_ = true;
+    return true;
+  }
+  void *memory = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd); // The mapping keeps the file alive
+  if (memory == MAP_FAILED) {
+    size_ = 0;
+    return false;
+  }
+#if defined(MADV_SEQUENTIAL) && defined(MADV_RANDOM)
+  madvise(memory, size_,
+          access == Access::RANDOM ? MADV_RANDOM : MADV_SEQUENTIAL);
+#endif
+  data_ = static_cast<const unsigned char *>(memory);
+  open_ = mapped_ = true;
+  return true;
+#else
+  (void)access;
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file)
+    return false;
+  buffer_.resize(static_cast<size_t>(file.tellg()));
+  file.seekg(0);
+  file.read(reinterpret_cast<char *>(buffer_.data()),
+            static_cast<std::streamsize>(buffer_.size()));
+  if (!file) {
+    buffer_.clear();
+    return false;
+  }
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+  open_ = true;
+  return true;
+#endif
+}
+
+void MappedFile::close() {
+#ifdef CHESS_HAS_MMAP
+  if (mapped_)
+    munmap(const_cast<unsigned char *>(data_), size_);
+#endif
+  data_ = nullptr;
+  size_ = 0;
+  open_ = mapped_ = false;
+  buffer_.clear();
+}
+
+bool MappedFile::isOpen() const { return open_; }
+
+const unsigned char *MappedFile::data() const { return data_; }
+
+size_t MappedFile::size() const { return size_; }
+
+std::string_view MappedFile::view() const {
+  return {reinterpret_cast<const char *>(data_), size_};
+}
+
+} // namespace chess
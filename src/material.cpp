@@ -0,0 +1,141 @@
+#include "material.hpp"
+#include "evaluation.hpp"
+#include "psqt.hpp"
+#include <algorithm>
+
+namespace chess {
+
+namespace {
+
+constexpr int BISHOP_PAIR_MG = 30, BISHOP_PAIR_EG = 50;
+// Knights gain and rooks lose value as pawns come off the board; both are
+// relative to five pawns of their own side.
+constexpr int KNIGHT_PAWN_ADJUSTMENT = 4;
+constexpr int ROOK_PAWN_ADJUSTMENT = -8;
+
+int count(const Board &board, Color color, PieceType type) {
+  return board.getPieceCount(color, type);
+}
+
+bool isBareKing(const Board &board, Color color) {
+  return count(board, color, PieceType::PAWN) == 0 &&
+         nonPawnMaterial(board, color) == 0;
+}
+
+bool onlyBishop(const Board &board, Color color) {
+  return count(board, color, PieceType::BISHOP) == 1 &&
+         nonPawnMaterial(board, color) == pieceValue(PieceType::BISHOP);
+}
+
+void findEndgame(const Board &board, MaterialEntry &entry) {
+  for (Color strong : {Color::WHITE, Color::BLACK}) {
+    if (!isBareKing(board, opposite(strong)))
+      continue;
+    const int pawns = count(board, strong, PieceType::PAWN);
+    const int material = nonPawnMaterial(board, strong);
+    endgame::EvaluationFunction evaluation = nullptr;
+    if (pawns == 1 && material == 0)
+      evaluation = endgame::evaluateKPK;
+    else if (pawns == 0 && count(board, strong, PieceType::BISHOP) == 1 &&
+             count(board, strong, PieceType::KNIGHT) == 1 &&
+             material == pieceValue(PieceType::BISHOP) +
+                             pieceValue(PieceType::KNIGHT))
+      evaluation = endgame::evaluateKBNK;
+    else if (pawns == 0 && material == count(board, strong, PieceType::KNIGHT) *
+                                           pieceValue(PieceType::KNIGHT))
+      evaluation = endgame::evaluateKNNK;
+    else if (material >= pieceValue(PieceType::ROOK))
+      evaluation = endgame::evaluateKXK;
+    if (evaluation) {
+      entry.evaluation = evaluation;
+      entry.strongSide = strong;
+      return;
+    }
+  }
+}
+
+void findScaling(const Board &board, MaterialEntry &entry) {
+  for (Color us : {Color::WHITE, Color::BLACK}) {
+    const Color them = opposite(us);
+    const int side = static_cast<int>(us);
+    const int pawns = count(board, us, PieceType::PAWN);
+    const int ours = nonPawnMaterial(board, us);
+    const int theirs = nonPawnMaterial(board, them);
+
+    if (onlyBishop(board, us) && onlyBishop(board, them))
+      entry.scaleFunction[side] = endgame::scaleOppositeBishops;
+    else if (onlyBishop(board, us) && pawns && theirs == 0)
+      entry.scaleFunction[side] = endgame::scaleKBPsK;
+
+    // Without pawns a minor piece up is not enough to win, and one pawn
+    // is often not enough to turn a small edge into a win.
+    if (pawns == 0 && ours - theirs <= pieceValue(PieceType::BISHOP)) {
+      if (ours < pieceValue(PieceType::ROOK))
+        entry.scaleFactor[side] = endgame::SCALE_DRAW;
+      else
+        entry.scaleFactor[side] =
+            theirs <= pieceValue(PieceType::BISHOP) ? 4 : 14;
+    } else if (pawns == 1 && ours - theirs <= pieceValue(PieceType::BISHOP))
+      entry.scaleFactor[side] = endgame::SCALE_ONE_PAWN;
+  }
+}
+
+} // namespace
+
+int MaterialEntry::scale(const Board &board, Color strong) const {
+  const int side = static_cast<int>(strong);
+  if (scaleFunction[side]) {
+    int factor = scaleFunction[side](board, strong);
+    if (factor != endgame::SCALE_NONE)
+      return factor;
+  }
+  return scaleFactor[side];
+}
+
+MaterialTable::MaterialTable() : entries_(ENTRY_COUNT) {}
+
+MaterialEntry &MaterialTable::probe(const Board &board) {
+  uint64_t key = board.getMaterialKey();
+  MaterialEntry &entry = entries_[key & (ENTRY_COUNT - 1)];
+  if (entry.key == key)
+    return entry;
+
+  entry = MaterialEntry();
+  entry.key = key;
+
+  int phase = 0;
+  for (Color color : {Color::WHITE, Color::BLACK})
+    for (int type = 1; type < 7; ++type)
+      phase += psqt::PHASE_WEIGHTS[type] *
+               count(board, color, static_cast<PieceType>(type));
+  entry.phase = static_cast<uint8_t>(std::min(phase, psqt::MAX_PHASE));
+
+  int mg = 0, eg = 0;
+  for (Color color : {Color::WHITE, Color::BLACK}) {
+    const int sign = color == Color::WHITE ? 1 : -1;
+    const int extraPawns = count(board, color, PieceType::PAWN) - 5;
+    if (count(board, color, PieceType::BISHOP) >= 2) {
+      mg += sign * BISHOP_PAIR_MG;
+      eg += sign * BISHOP_PAIR_EG;
+    }
+    int adjustment =
+        count(board, color, PieceType::KNIGHT) * KNIGHT_PAWN_ADJUSTMENT *
+            extraPawns +
+        count(board, color, PieceType::ROOK) * ROOK_PAWN_ADJUSTMENT *
+            extraPawns;
+    mg += sign * adjustment;
+    eg += sign * adjustment;
+  }
+  entry.midgameImbalance = static_cast<int16_t>(mg);
+  entry.endgameImbalance = static_cast<int16_t>(eg);
+
+  findEndgame(board, entry);
+  findScaling(board, entry);
+  return entry;
+}
+
+void MaterialTable::clear() {
+  std::fill(entries_.begin(), entries_.end(), MaterialEntry());
+}
+
+} // namespace chess
@@ -1,6 +1,8 @@
 #include "move.hpp"
 
 namespace chess {
+Move::Move() : Move(0, 0, 0, 0) {}
+
 Move::Move(int startRow, int startCol, int endRow, int endCol,
            PieceType promotionType)
     : startRow(startRow), startCol(startCol), endRow(endRow), endCol(endCol),
@@ -12,4 +14,19 @@ bool Move::operator==(const Move &other) const {
           promotionType == other.promotionType);
 }
 
+bool Move::operator!=(const Move &other) const { return !(*this == other); }
+
+uint16_t Move::pack() const {
+  return static_cast<uint16_t>((startRow * BOARD_SIZE + startCol) |
+                               (endRow * BOARD_SIZE + endCol) << 6 |
+                               static_cast<int>(promotionType) << 12);
+}
+
+Move Move::unpack(uint16_t packed) {
+  int from = packed & 0x3F;
+  int to = (packed >> 6) & 0x3F;
+  return Move(from / BOARD_SIZE, from % BOARD_SIZE, to / BOARD_SIZE,
+              to % BOARD_SIZE, static_cast<PieceType>((packed >> 12) & 0x7));
+}
+
 } // namespace chess
@@ -6,30 +6,49 @@ namespace chess {
 
 std::vector<Move> MoveGenerator::generateMoves(const Board &board,
                                                Color color) const {
-  std::vector<Move> moves;
+  MoveList list;
+  generate(board, color, list, false);
+  return std::vector<Move>(list.begin(), list.end());
+}
+
+void MoveGenerator::generateMoves(const Board &board, Color color,
+                                  MoveList &moves) const {
+  moves.clear();
+  generate(board, color, moves, false);
+}
 
+void MoveGenerator::generateCaptures(const Board &board, Color color,
+                                     MoveList &moves) const {
+  moves.clear();
+  generate(board, color, moves, true);
+}
+
+void MoveGenerator::generate(const Board &board, Color color, MoveList &moves,
+                             bool capturesOnly) const {
   for (int row = 0; row < BOARD_SIZE; ++row) {
     for (int col = 0; col < BOARD_SIZE; ++col) {
       const Piece &piece = board.getPiece(row, col);
       if (piece.getColor() == color) {
         switch (piece.getType()) {
         case PieceType::PAWN:
-          generatePawnMoves(board, row, col, moves);
+          generatePawnMoves(board, row, col, moves, capturesOnly);
           break;
         case PieceType::KNIGHT:
-          generateKnightMoves(board, row, col, moves);
+          generateKnightMoves(board, row, col, moves, capturesOnly);
           break;
         case PieceType::BISHOP:
-          generateBishopMoves(board, row, col, moves);
+          generateBishopMoves(board, row, col, moves, capturesOnly);
           break;
         case PieceType::ROOK:
-          generateRookMoves(board, row, col, moves);
+          generateRookMoves(board, row, col, moves, capturesOnly);
           break;
         case PieceType::QUEEN:
-          generateQueenMoves(board, row, col, moves);
+          generateQueenMoves(board, row, col, moves, capturesOnly);
           break;
         case PieceType::KING:
-          generateKingMoves(board, row, col, moves);
+          generateKingMoves(board, row, col, moves, capturesOnly);
+          if (!capturesOnly)
+            generateCastlingMoves(board, row, col, moves);
           break;
         case PieceType::NONE:
           break;
@@ -37,11 +56,10 @@ std::vector<Move> MoveGenerator::generateMoves(const Board &board,
       }
     }
   }
-  return moves;
 }
 
 bool MoveGenerator::isValidSquare(int row, int col) const {
-  return row >= 0 && row < BOARD_SIZE && col >= 0 && BOARD_SIZE;
+  return row >= 0 && row < BOARD_SIZE && col >= 0 && col < BOARD_SIZE;
 }
 bool MoveGenerator::isOpponentPiece(const Board &board, int row, int col,
                                     Color color) const {
@@ -49,42 +67,60 @@ bool MoveGenerator::isOpponentPiece(const Board &board, int row, int col,
          board.getPiece(row, col).getColor() != color;
 }
 
+void MoveGenerator::addPawnMove(int row, int col, int newRow, int newCol,
+                                MoveList &moves) const {
+  if (newRow == 0 || newRow == BOARD_SIZE - 1) {
+    moves.emplace_back(row, col, newRow, newCol, PieceType::QUEEN);
+    moves.emplace_back(row, col, newRow, newCol, PieceType::ROOK);
+    moves.emplace_back(row, col, newRow, newCol, PieceType::BISHOP);
+    moves.emplace_back(row, col, newRow, newCol, PieceType::KNIGHT);
+  } else {
+    moves.emplace_back(row, col, newRow, newCol);
+  }
+}
+
 void MoveGenerator::generatePawnMoves(const Board &board, int row, int col,
-                                      std::vector<Move> &moves) const {
-  int direction =
-      (board.getPiece(row, col).getColor() == Color::WHITE) ? 1 : -1;
-  int startRow = (board.getPiece(row, col).getColor() == Color::WHITE) ? 1 : 6;
+                                      MoveList &moves,
+                                      bool capturesOnly) const {
+  Color color = board.getPiece(row, col).getColor();
+  int direction = (color == Color::WHITE) ? 1 : -1;
+  int startRow = (color == Color::WHITE) ? 1 : 6;
+  int promotionRow = (color == Color::WHITE) ? BOARD_SIZE - 1 : 0;
   if (isValidSquare(row + direction, col) &&
       board.getPiece(row + direction, col).isEmpty()) {
-    moves.emplace_back(row, col, row + direction, col);
-    if (row == startRow && isValidSquare(row + 2 * direction, col) &&
+    if (!capturesOnly || row + direction == promotionRow)
+      addPawnMove(row, col, row + direction, col, moves);
+    if (!capturesOnly && row == startRow &&
+        isValidSquare(row + 2 * direction, col) &&
         board.getPiece(row + 2 * direction, col).isEmpty())
       moves.emplace_back(row, col, row + 2 * direction, col);
   }
 
-  if (isValidSquare(row + direction, col + 1) &&
-      isOpponentPiece(board, row + direction, col + 1,
-                      board.getPiece(row, col).getColor()))
-    moves.emplace_back(row, col, row + direction, col + 1);
+  if (isOpponentPiece(board, row + direction, col + 1, color))
+    addPawnMove(row, col, row + direction, col + 1, moves);
 
-  if (isValidSquare(row + direction, col - 1) &&
-      isOpponentPiece(board, row + direction, col - 1,
-                      board.getPiece(row, col).getColor()))
-    moves.emplace_back(row, col, row + direction, col - 1);
+  if (isOpponentPiece(board, row + direction, col - 1, color))
+    addPawnMove(row, col, row + direction, col - 1, moves);
 
-  // TODO: Add End Passant
-  // TODO Add Promotion
+  // En passant: the target file is set only right after a double push.
+  int enPassantCol = board.getEnPassantCol();
+  int enPassantRow = (color == Color::WHITE) ? 4 : 3;
+  if (enPassantCol >= 0 && row == enPassantRow &&
+      (enPassantCol == col + 1 || enPassantCol == col - 1) &&
+      board.getSideToMove() == color)
+    moves.emplace_back(row, col, row + direction, enPassantCol);
 }
 
 void MoveGenerator::generateKnightMoves(const Board &board, int row, int col,
-                                        std::vector<Move> &moves) const {
+                                        MoveList &moves,
+                                        bool capturesOnly) const {
   int offsets[][2] = {{-2, -1}, {-2, 1}, {-1, -2}, {-1, 2},
                       {1, -2},  {1, 2},  {2, -1},  {2, 1}};
   for (auto offset : offsets) {
     int newRow = row + offset[0];
     int newCol = col + offset[1];
     if (isValidSquare(newRow, newCol)) {
-      if (board.getPiece(newRow, newCol).isEmpty() ||
+      if ((!capturesOnly && board.getPiece(newRow, newCol).isEmpty()) ||
           isOpponentPiece(board, newRow, newCol,
                           board.getPiece(row, col).getColor()))
         moves.emplace_back(row, col, newRow, newCol);
@@ -93,7 +129,8 @@ void MoveGenerator::generateKnightMoves(const Board &board, int row, int col,
 }
 
 void MoveGenerator::generateBishopMoves(const Board &board, int row, int col,
-                                        std::vector<Move> &moves) const {
+                                        MoveList &moves,
+                                        bool capturesOnly) const {
   int rowOffsets[] = {-1, -1, 1, 1};
   int colOffsets[] = {-1, 1, -1, 1};
   for (int i = 0; i < 4; ++i) {
@@ -102,10 +139,11 @@ void MoveGenerator::generateBishopMoves(const Board &board, int row, int col,
       int newCol = col + j * colOffsets[i];
       if (!isValidSquare(newRow, newCol))
         break;
-      if (board.getPiece(newRow, newCol).isEmpty())
-        moves.emplace_back(row, col, newRow, newCol);
-      else if (isOpponentPiece(board, newRow, newCol,
-                               board.getPiece(row, col).getColor())) {
+      if (board.getPiece(newRow, newCol).isEmpty()) {
+        if (!capturesOnly)
+          moves.emplace_back(row, col, newRow, newCol);
+      } else if (isOpponentPiece(board, newRow, newCol,
+                                 board.getPiece(row, col).getColor())) {
 
         moves.emplace_back(row, col, newRow, newCol);
         break;
@@ -116,19 +154,21 @@ void MoveGenerator::generateBishopMoves(const Board &board, int row, int col,
 }
 
 void MoveGenerator::generateRookMoves(const Board &board, int row, int col,
-                                      std::vector<Move> &moves) const {
-  int rowOffsets[] = {-1, -1, 1, 1};
-  int colOffsets[] = {-1, 1, -1, 1};
+                                      MoveList &moves,
+                                      bool capturesOnly) const {
+  int rowOffsets[] = {-1, 1, 0, 0};
+  int colOffsets[] = {0, 0, -1, 1};
   for (int i = 0; i < 4; ++i) {
     for (int j = 1; j < BOARD_SIZE; ++j) {
       int newRow = row + j * rowOffsets[i];
       int newCol = col + j * colOffsets[i];
       if (!isValidSquare(newRow, newCol))
         break;
-      if (board.getPiece(newRow, newCol).isEmpty())
-        moves.emplace_back(row, col, newRow, newCol);
-      else if (isOpponentPiece(board, newRow, newCol,
-                               board.getPiece(row, col).getColor())) {
+      if (board.getPiece(newRow, newCol).isEmpty()) {
+        if (!capturesOnly)
+          moves.emplace_back(row, col, newRow, newCol);
+      } else if (isOpponentPiece(board, newRow, newCol,
+                                 board.getPiece(row, col).getColor())) {
 
         moves.emplace_back(row, col, newRow, newCol);
         break;
@@ -139,20 +179,22 @@ void MoveGenerator::generateRookMoves(const Board &board, int row, int col,
 }
 
 void MoveGenerator::generateQueenMoves(const Board &board, int row, int col,
-                                       std::vector<Move> &moves) const {
-  generateRookMoves(board, row, col, moves);
-  generateBishopMoves(board, row, col, moves);
+                                       MoveList &moves,
+                                       bool capturesOnly) const {
+  generateRookMoves(board, row, col, moves, capturesOnly);
+  generateBishopMoves(board, row, col, moves, capturesOnly);
 }
 
 void MoveGenerator::generateKingMoves(const Board &board, int row, int col,
-                                      std::vector<Move> &moves) const {
+                                      MoveList &moves,
+                                      bool capturesOnly) const {
   int offsets[][2] = {{-1, -1}, {-1, 0}, {-1, 1}, {0, -1},
                       {0, 1},   {1, -1}, {1, 0},  {1, 1}};
   for (auto offset : offsets) {
     int newRow = row + offset[0];
     int newCol = col + offset[1];
     if (isValidSquare(newRow, newCol)) {
-      if (board.getPiece(newRow, newCol).isEmpty() ||
+      if ((!capturesOnly && board.getPiece(newRow, newCol).isEmpty()) ||
           isOpponentPiece(board, newRow, newCol,
                           board.getPiece(row, col).getColor()))
         moves.emplace_back(row, col, newRow, newCol);
@@ -160,4 +202,39 @@ void MoveGenerator::generateKingMoves(const Board &board, int row, int col,
   }
 }
 
+void MoveGenerator::generateCastlingMoves(const Board &board, int row, int col,
+                                          MoveList &moves) const {
+  Color color = board.getPiece(row, col).getColor();
+  int homeRow = (color == Color::WHITE) ? 0 : BOARD_SIZE - 1;
+  int rights = board.getCastlingRights();
+  int kingside = (color == Color::WHITE) ? WHITE_KINGSIDE : BLACK_KINGSIDE;
+  int queenside = (color == Color::WHITE) ? WHITE_QUEENSIDE : BLACK_QUEENSIDE;
+  const Piece ownRook(PieceType::ROOK, color);
+  if (row != homeRow || col != 4 || !(rights & (kingside | queenside)))
+    return;
+  Color enemy = opposite(color);
+  if (board.isSquareAttacked(row, col, enemy))
+    return;
+
+  auto isOwnRook = [&](int rookCol) {
+    const Piece &piece = board.getPiece(row, rookCol);
+    return piece.getType() == ownRook.getType() &&
+           piece.getColor() == ownRook.getColor();
+  };
+
+  if ((rights & kingside) && isOwnRook(BOARD_SIZE - 1) &&
+      board.getPiece(row, 5).isEmpty() &&
+      board.getPiece(row, 6).isEmpty() &&
+      !board.isSquareAttacked(row, 5, enemy) &&
+      !board.isSquareAttacked(row, 6, enemy))
+    moves.emplace_back(row, col, row, 6);
+
+  if ((rights & queenside) && isOwnRook(0) &&
+      board.getPiece(row, 3).isEmpty() &&
+      board.getPiece(row, 2).isEmpty() && board.getPiece(row, 1).isEmpty() &&
+      !board.isSquareAttacked(row, 3, enemy) &&
+      !board.isSquareAttacked(row, 2, enemy))
+    moves.emplace_back(row, col, row, 2);
+}
+
 } // namespace chess
@@ -0,0 +1,268 @@
+#include "nnue.hpp"
+#include "nnue_kernels.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+namespace chess {
+namespace nnue {
+
+namespace {
+
+constexpr uint32_t FILE_VERSION = 0x7AF32F16;
+constexpr int TRANSFORMED_DIMENSIONS = 2 * HALF_DIMENSIONS;
+constexpr int WEIGHT_SCALE_BITS = 6;
+constexpr int OUTPUT_SCALE = 16;
+// Networks are trained in Stockfish's internal units, where an endgame pawn
+// is worth 208.
+constexpr int NETWORK_PAWN_VALUE = 208;
+
+struct Network {
+  std::string description;
+  const Kernels *kernels; // Best instruction set of this CPU
+  std::vector<int16_t> featureBiases;  // [HALF_DIMENSIONS]
+  std::vector<int16_t> featureWeights; // [INPUT_DIMENSIONS][HALF_DIMENSIONS]
+  std::vector<int32_t> hidden1Biases;  // [HIDDEN_DIMENSIONS]
+  std::vector<int8_t> hidden1Weights;  // [HIDDEN][TRANSFORMED_DIMENSIONS]
+  std::vector<int32_t> hidden2Biases;
+  std::vector<int8_t> hidden2Weights; // [HIDDEN][HIDDEN]
+  std::vector<int32_t> outputBias;    // [1]
+  std::vector<int8_t> outputWeights;  // [HIDDEN]
+};
+
+std::unique_ptr<const Network> currentNetwork;
+uint32_t networkGeneration = 0; // Bumped on every load to drop stale caches
+
+// The file is little-endian, like every platform this builds for.
+template <typename T>
+bool readValues(std::istream &in, std::vector<T> &values, size_t count) {
+  values.resize(count);
+  in.read(reinterpret_cast<char *>(values.data()),
+          static_cast<std::streamsize>(count * sizeof(T)));
+  return static_cast<bool>(in);
+}
+
+bool readUint32(std::istream &in, uint32_t &value) {
+  in.read(reinterpret_cast<char *>(&value), sizeof(value));
+  return static_cast<bool>(in);
+}
+
+bool kingMoved(const DirtyPieces &dirty, Color perspective) {
+  for (int i = 0; i < dirty.count; ++i)
+    if (dirty.pieces[i].piece.getType() == PieceType::KING &&
+        dirty.pieces[i].piece.getColor() == perspective)
+      return true;
+  return false;
+}
+
+// Input index of a non-king piece as seen from one perspective. Black's
+// view is rotated so that both sides see their own pieces moving up.
+int featureIndex(Color perspective, int kingSquare, const Piece &piece,
+                 int square) {
+  const int flip = perspective == Color::WHITE ? 0 : 63;
+  const int kind = 1 + (static_cast<int>(piece.getType()) - 1) * 128 +
+                   (piece.getColor() == perspective ? 0 : 64);
+  return (square ^ flip) + kind + PIECE_SQUARE_COUNT * (kingSquare ^ flip);
+}
+
+void addFeature(int16_t *values, int index) {
+  currentNetwork->kernels->addRow(
+      values, &currentNetwork->featureWeights[static_cast<size_t>(index) *
+                                              HALF_DIMENSIONS]);
+}
+
+void subtractFeature(int16_t *values, int index) {
+  currentNetwork->kernels->subtractRow(
+      values, &currentNetwork->featureWeights[static_cast<size_t>(index) *
+                                              HALF_DIMENSIONS]);
+}
+
+void clippedRelu(const int32_t *input, int count, uint8_t *output) {
+  for (int i = 0; i < count; ++i)
+    output[i] = static_cast<uint8_t>(
+        std::clamp(input[i] >> WEIGHT_SCALE_BITS, 0, 127));
+}
+
+} // namespace
+
+bool loadNetwork(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  auto network = std::make_unique<Network>();
+  network->kernels = &activeKernels();
+  uint32_t version = 0, hash = 0, length = 0;
+  if (!readUint32(in, version) || version != FILE_VERSION ||
+      !readUint32(in, hash) || !readUint32(in, length) || length > 4096)
+    return false;
+  network->description.resize(length);
+  in.read(network->description.data(), length);
+
+  // Each section starts with a hash of its architecture, which this fixed
+  // layout does not need; the exact file size checks the shape instead.
+  bool ok =
+      readUint32(in, hash) &&
+      readValues(in, network->featureBiases, HALF_DIMENSIONS) &&
+      readValues(in, network->featureWeights,
+                 static_cast<size_t>(INPUT_DIMENSIONS) * HALF_DIMENSIONS) &&
+      readUint32(in, hash) &&
+      readValues(in, network->hidden1Biases, HIDDEN_DIMENSIONS) &&
+      readValues(in, network->hidden1Weights,
+                 HIDDEN_DIMENSIONS * TRANSFORMED_DIMENSIONS) &&
+      readValues(in, network->hidden2Biases, HIDDEN_DIMENSIONS) &&
+      readValues(in, network->hidden2Weights,
+                 HIDDEN_DIMENSIONS * HIDDEN_DIMENSIONS) &&
+      readValues(in, network->outputBias, 1) &&
+      readValues(in, network->outputWeights, HIDDEN_DIMENSIONS);
+  if (!ok || in.peek() != std::char_traits<char>::eof())
+    return false;
+
+  currentNetwork = std::move(network);
+  ++networkGeneration;
+  return true;
+}
+
+void unloadNetwork() {
+  currentNetwork.reset();
+  ++networkGeneration;
+}
+
+bool isLoaded() { return currentNetwork != nullptr; }
+
+const std::string &getDescription() {
+  static const std::string NONE;
+  return currentNetwork ? currentNetwork->description : NONE;
+}
+
+AccumulatorStack::AccumulatorStack() : refreshTable_(2 * 64) {}
+
+void AccumulatorStack::refresh(const Board &board, Accumulator &accumulator,
+                               Color perspective) {
+  const int kingSquare = board.getKingSquare(perspective);
+  RefreshEntry &entry =
+      refreshTable_[static_cast<int>(perspective) * 64 + kingSquare];
+  if (!entry.valid) {
+    std::memcpy(entry.values.data(), currentNetwork->featureBiases.data(),
+                HALF_DIMENSIONS * sizeof(int16_t));
+    entry.pieces = {};
+    entry.valid = true;
+  }
+
+  for (Color color : {Color::WHITE, Color::BLACK}) {
+    for (int type = static_cast<int>(PieceType::PAWN);
+         type < static_cast<int>(PieceType::KING); ++type) {
+      const Piece piece(static_cast<PieceType>(type), color);
+      Bitboard &cached = entry.pieces[static_cast<int>(color)][type];
+      const Bitboard current = board.getPieces(color, piece.getType());
+      for (Bitboard removed = cached & ~current; removed;)
+        subtractFeature(entry.values.data(),
+                        featureIndex(perspective, kingSquare, piece,
+                                     popLsb(removed)));
+      for (Bitboard added = current & ~cached; added;)
+        addFeature(entry.values.data(),
+                   featureIndex(perspective, kingSquare, piece,
+                                popLsb(added)));
+      cached = current;
+    }
+  }
+  accumulator.values[static_cast<int>(perspective)] = entry.values;
+}
+
+int AccumulatorStack::findComputedAncestor(const Board &board,
+                                           Color perspective) const {
+  const int side = static_cast<int>(perspective);
+  for (int ply = board.getHistorySize(); ply > 0; --ply) {
+    // Positions before a king move use other features altogether.
+    if (kingMoved(board.getDirtyPieces(ply - 1), perspective))
+      return -1;
+    const Accumulator &ancestor = stack_[ply - 1];
+    if (ancestor.computed[side] &&
+        ancestor.key == board.getHistoryHash(ply - 1))
+      return ply - 1;
+  }
+  return -1;
+}
+
+Accumulator &AccumulatorStack::update(const Board &board) {
+  if (networkGeneration_ != networkGeneration) {
+    for (Accumulator &accumulator : stack_)
+      accumulator.computed = {};
+    for (RefreshEntry &entry : refreshTable_)
+      entry.valid = false;
+    networkGeneration_ = networkGeneration;
+  }
+
+  const int ply = board.getHistorySize();
+  if (static_cast<int>(stack_.size()) <= ply)
+    stack_.resize(ply + 1);
+  Accumulator &accumulator = stack_[ply];
+  if (accumulator.key != board.getHash()) {
+    accumulator.key = board.getHash();
+    accumulator.computed = {};
+  }
+
+  for (Color perspective : {Color::WHITE, Color::BLACK}) {
+    const int side = static_cast<int>(perspective);
+    if (accumulator.computed[side])
+      continue;
+    accumulator.computed[side] = true;
+    const int ancestor = findComputedAncestor(board, perspective);
+    if (ancestor < 0) {
+      refresh(board, accumulator, perspective);
+      continue;
+    }
+
+    int16_t *values = accumulator.values[side].data();
+    std::memcpy(values, stack_[ancestor].values[side].data(),
+                HALF_DIMENSIONS * sizeof(int16_t));
+    const int kingSquare = board.getKingSquare(perspective);
+    for (int i = ancestor; i < ply; ++i) {
+      const DirtyPieces &dirty = board.getDirtyPieces(i);
+      for (int j = 0; j < dirty.count; ++j) {
+        const DirtyPiece &change = dirty.pieces[j];
+        if (change.piece.getType() == PieceType::KING)
+          continue;
+        if (change.from >= 0)
+          subtractFeature(values, featureIndex(perspective, kingSquare,
+                                               change.piece, change.from));
+        if (change.to >= 0)
+          addFeature(values, featureIndex(perspective, kingSquare,
+                                          change.piece, change.to));
+      }
+    }
+  }
+  return accumulator;
+}
+
+int AccumulatorStack::evaluate(const Board &board) {
+  const Accumulator &accumulator = update(board);
+  const Network &network = *currentNetwork;
+
+  // Side to move first, each half clipped to 0..127.
+  alignas(64) uint8_t transformed[TRANSFORMED_DIMENSIONS];
+  const int us = static_cast<int>(board.getSideToMove());
+  for (int half = 0; half < 2; ++half) {
+    const auto &values = accumulator.values[half == 0 ? us : 1 - us];
+    for (int i = 0; i < HALF_DIMENSIONS; ++i)
+      transformed[half * HALF_DIMENSIONS + i] =
+          static_cast<uint8_t>(std::clamp<int>(values[i], 0, 127));
+  }
+
+  alignas(64) int32_t sums[HIDDEN_DIMENSIONS];
+  alignas(64) uint8_t hidden1[HIDDEN_DIMENSIONS];
+  alignas(64) uint8_t hidden2[HIDDEN_DIMENSIONS];
+  const Kernels &kernels = *network.kernels;
+  kernels.affine(transformed, TRANSFORMED_DIMENSIONS,
+                 network.hidden1Weights.data(), network.hidden1Biases.data(),
+                 HIDDEN_DIMENSIONS, sums);
+  clippedRelu(sums, HIDDEN_DIMENSIONS, hidden1);
+  kernels.affine(hidden1, HIDDEN_DIMENSIONS, network.hidden2Weights.data(),
+                 network.hidden2Biases.data(), HIDDEN_DIMENSIONS, sums);
+  clippedRelu(sums, HIDDEN_DIMENSIONS, hidden2);
+  int32_t output;
+  kernels.affine(hidden2, HIDDEN_DIMENSIONS, network.outputWeights.data(),
+                 network.outputBias.data(), 1, &output);
+  return output / OUTPUT_SCALE * 100 / NETWORK_PAWN_VALUE;
+}
+
+} // namespace nnue
+} // namespace chess
@@ -0,0 +1,228 @@
+#include "nnue_kernels.hpp"
+#include "nnue.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define CHESS_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace chess {
+namespace nnue {
+
+namespace {
+
+void addRowScalar(int16_t *values, const int16_t *weights) {
+  for (int i = 0; i < HALF_DIMENSIONS; ++i)
+    values[i] += weights[i];
+}
+
+void subtractRowScalar(int16_t *values, const int16_t *weights) {
+  for (int i = 0; i < HALF_DIMENSIONS; ++i)
+    values[i] -= weights[i];
+}
+
+void affineScalar(const uint8_t *input, int inputs, const int8_t *weights,
+                  const int32_t *biases, int outputs, int32_t *output) {
+  for (int i = 0; i < outputs; ++i) {
+    int32_t sum = biases[i];
+    const int8_t *row = weights + i * inputs;
+    for (int j = 0; j < inputs; ++j)
+      sum += row[j] * input[j];
+    output[i] = sum;
+  }
+}
+
+const Kernels SCALAR = {"scalar", addRowScalar, subtractRowScalar,
+                        affineScalar};
+
+#ifdef CHESS_X86_KERNELS
+
+// The byte products go through _mm*_maddubs_epi16, whose int16 pair sums
+// cannot saturate: inputs are clipped to 0..127 and weights are int8.
+
+__attribute__((target("sse4.1"))) void addRowSse41(int16_t *values,
+                                                    const int16_t *weights) {
+  for (int i = 0; i < HALF_DIMENSIONS; i += 8) {
+    __m128i *v = reinterpret_cast<__m128i *>(values + i);
+    __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + i));
+    _mm_storeu_si128(v, _mm_add_epi16(_mm_loadu_si128(v), w));
+  }
+}
+
+__attribute__((target("sse4.1"))) void
+subtractRowSse41(int16_t *values, const int16_t *weights) {
+  for (int i = 0; i < HALF_DIMENSIONS; i += 8) {
+    __m128i *v = reinterpret_cast<__m128i *>(values + i);
+    __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + i));
+    _mm_storeu_si128(v, _mm_sub_epi16(_mm_loadu_si128(v), w));
+  }
+}
+
+__attribute__((target("sse4.1"))) void
+affineSse41(const uint8_t *input, int inputs, const int8_t *weights,
+            const int32_t *biases, int outputs, int32_t *output) {
+  const __m128i ones = _mm_set1_epi16(1);
+  for (int i = 0; i < outputs; ++i) {
+    const int8_t *row = weights + i * inputs;
+    __m128i sum = _mm_setzero_si128();
+    for (int j = 0; j < inputs; j += 16) {
+      __m128i products = _mm_maddubs_epi16(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + j)),
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + j)));
+      sum = _mm_add_epi32(sum, _mm_madd_epi16(products, ones));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    output[i] = biases[i] + _mm_cvtsi128_si32(sum);
+  }
+}
+
+__attribute__((target("avx2"))) void addRowAvx2(int16_t *values,
+                                                const int16_t *weights) {
+  for (int i = 0; i < HALF_DIMENSIONS; i += 16) {
+    __m256i *v = reinterpret_cast<__m256i *>(values + i);
+    __m256i w =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + i));
+    _mm256_storeu_si256(v, _mm256_add_epi16(_mm256_loadu_si256(v), w));
+  }
+}
+
+__attribute__((target("avx2"))) void subtractRowAvx2(int16_t *values,
+                                                     const int16_t *weights) {
+  for (int i = 0; i < HALF_DIMENSIONS; i += 16) {
+    __m256i *v = reinterpret_cast<__m256i *>(values + i);
+    __m256i w =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + i));
+    _mm256_storeu_si256(v, _mm256_sub_epi16(_mm256_loadu_si256(v), w));
+  }
+}
+
+__attribute__((target("avx2"))) int32_t horizontalSumAvx2(__m256i sum) {
+  __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum),
+                               _mm256_extracti128_si256(sum, 1));
+  half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+  half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+  return _mm_cvtsi128_si32(half);
+}
+
+__attribute__((target("avx2"))) void
+affineAvx2(const uint8_t *input, int inputs, const int8_t *weights,
+           const int32_t *biases, int outputs, int32_t *output) {
+  const __m256i ones = _mm256_set1_epi16(1);
+  for (int i = 0; i < outputs; ++i) {
+    const int8_t *row = weights + i * inputs;
+    __m256i sum = _mm256_setzero_si256();
+    for (int j = 0; j < inputs; j += 32) {
+      __m256i products = _mm256_maddubs_epi16(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + j)),
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + j)));
+      sum = _mm256_add_epi32(sum, _mm256_madd_epi16(products, ones));
+    }
+    output[i] = biases[i] + horizontalSumAvx2(sum);
+  }
+}
+
+// Through memory: the register-only reductions trip GCC 12's
+// -Wmaybe-uninitialized inside its own headers. Runs once per output.
+__attribute__((target("avx512f"))) int32_t horizontalSumAvx512(__m512i sum) {
+  alignas(64) int32_t lanes[16];
+  _mm512_store_si512(lanes, sum);
+  int32_t total = 0;
+  for (int32_t lane : lanes)
+    total += lane;
+  return total;
+}
+
+__attribute__((target("avx512f,avx512bw"))) void
+addRowAvx512(int16_t *values, const int16_t *weights) {
+  for (int i = 0; i < HALF_DIMENSIONS; i += 32)
+    _mm512_storeu_si512(values + i,
+                        _mm512_add_epi16(_mm512_loadu_si512(values + i),
+                                         _mm512_loadu_si512(weights + i)));
+}
+
+__attribute__((target("avx512f,avx512bw"))) void
+subtractRowAvx512(int16_t *values, const int16_t *weights) {
+  for (int i = 0; i < HALF_DIMENSIONS; i += 32)
+    _mm512_storeu_si512(values + i,
+                        _mm512_sub_epi16(_mm512_loadu_si512(values + i),
+                                         _mm512_loadu_si512(weights + i)));
+}
+
+// Layers narrower than a 512-bit register use the AVX2 loop.
+__attribute__((target("avx512f,avx512bw"))) void
+affineAvx512(const uint8_t *input, int inputs, const int8_t *weights,
+             const int32_t *biases, int outputs, int32_t *output) {
+  if (inputs % 64 != 0) {
+    affineAvx2(input, inputs, weights, biases, outputs, output);
+    return;
+  }
+  const __m512i ones = _mm512_set1_epi16(1);
+  for (int i = 0; i < outputs; ++i) {
+    const int8_t *row = weights + i * inputs;
+    __m512i sum = _mm512_setzero_si512();
+    for (int j = 0; j < inputs; j += 64) {
+      __m512i products = _mm512_maddubs_epi16(_mm512_loadu_si512(input + j),
+                                              _mm512_loadu_si512(row + j));
+      sum = _mm512_add_epi32(sum, _mm512_madd_epi16(products, ones));
+    }
+    output[i] = biases[i] + horizontalSumAvx512(sum);
+  }
+}
+
+// VNNI fuses the multiply, pair sum and accumulate into one instruction.
+__attribute__((target("avx512f,avx512bw,avx512vnni"))) void
+affineAvx512Vnni(const uint8_t *input, int inputs, const int8_t *weights,
+                 const int32_t *biases, int outputs, int32_t *output) {
+  if (inputs % 64 != 0) {
+    affineAvx2(input, inputs, weights, biases, outputs, output);
+    return;
+  }
+  for (int i = 0; i < outputs; ++i) {
+    const int8_t *row = weights + i * inputs;
+    __m512i sum = _mm512_setzero_si512();
+    for (int j = 0; j < inputs; j += 64)
+      sum = _mm512_dpbusd_epi32(sum, _mm512_loadu_si512(input + j),
+                                _mm512_loadu_si512(row + j));
+    output[i] = biases[i] + horizontalSumAvx512(sum);
+  }
+}
+
+const Kernels SSE41 = {"sse4.1", addRowSse41, subtractRowSse41, affineSse41};
+const Kernels AVX2 = {"avx2", addRowAvx2, subtractRowAvx2, affineAvx2};
+const Kernels AVX512 = {"avx512bw", addRowAvx512, subtractRowAvx512,
+                        affineAvx512};
+const Kernels AVX512_VNNI = {"avx512-vnni", addRowAvx512, subtractRowAvx512,
+                             affineAvx512Vnni};
+
+#endif // CHESS_X86_KERNELS
+
+} // namespace
+
+std::vector<const Kernels *> supportedKernels() {
+  std::vector<const Kernels *> kernels;
+#ifdef CHESS_X86_KERNELS
+  __builtin_cpu_init(); // May run before main, from a static initializer
+  const bool avx2 = __builtin_cpu_supports("avx2");
+  const bool avx512 = avx2 && __builtin_cpu_supports("avx512f") &&
+                      __builtin_cpu_supports("avx512bw");
+  if (avx512 && __builtin_cpu_supports("avx512vnni"))
+    kernels.push_back(&AVX512_VNNI);
+  if (avx512)
+    kernels.push_back(&AVX512);
+  if (avx2)
+    kernels.push_back(&AVX2);
+  if (__builtin_cpu_supports("sse4.1"))
+    kernels.push_back(&SSE41);
+#endif
+  kernels.push_back(&SCALAR);
+  return kernels;
+}
+
+const Kernels &activeKernels() {
+  static const Kernels &KERNELS = *supportedKernels().front();
+  return KERNELS;
+}
+
+} // namespace nnue
+} // namespace chess
@@ -0,0 +1,304 @@
+#include "notation.hpp"
+#include "move_generator.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+namespace chess {
+
+namespace {
+
+constexpr const char *PROMOTION_LETTERS = "nbrq"; // Knight to queen
+constexpr const char *SAN_LETTERS = " PNBRQK";    // Indexed by PieceType
+
+int squareOf(int row, int col) { return row * BOARD_SIZE + col; }
+
+bool isLegal(Board &board, const Move &move) {
+  board.makeMove(move);
+  bool legal = !board.isInCheck(opposite(board.getSideToMove()));
+  board.unmakeMove(move);
+  return legal;
+}
+
+bool hasLegalMove(Board &board) {
+  MoveList moves;
+  MoveGenerator().generateMoves(board, board.getSideToMove(), moves);
+  for (const Move &move : moves)
+    if (isLegal(board, move))
+      return true;
+  return false;
+}
+
+// Pieces of one kind and side that attack the square.
+Bitboard attackersOf(const Board &board, Color color, PieceType type,
+                     int square) {
+  const Bitboard occupied =
+      board.getOccupied(Color::WHITE) | board.getOccupied(Color::BLACK);
+  const Bitboard pieces = board.getPieces(color, type);
+  switch (type) {
+  case PieceType::KNIGHT:
+    return knightAttacks(square) & pieces;
+  case PieceType::BISHOP:
+    return bishopAttacks(square, occupied) & pieces;
+  case PieceType::ROOK:
+    return rookAttacks(square, occupied) & pieces;
+  case PieceType::QUEEN:
+    return (bishopAttacks(square, occupied) | rookAttacks(square, occupied)) &
+           pieces;
+  case PieceType::KING:
+    return kingAttacks(square) & pieces;
+  default:
+    return 0;
+  }
+}
+
+// Castling the given way, or the null move if the rules forbid it now.
+// The same conditions as the move generator's.
+Move castlingMove(const Board &board, bool kingside) {
+  const Color us = board.getSideToMove(), them = opposite(us);
+  const int row = us == Color::WHITE ? 0 : BOARD_SIZE - 1;
+  const int right = us == Color::WHITE
+                        ? (kingside ? WHITE_KINGSIDE : WHITE_QUEENSIDE)
+                        : (kingside ? BLACK_KINGSIDE : BLACK_QUEENSIDE);
+  const int rookCol = kingside ? BOARD_SIZE - 1 : 0;
+  const int kingCol = kingside ? 6 : 2;
+  const Piece &rook = board.getPiece(row, rookCol);
+  if (!(board.getCastlingRights() & right) ||
+      board.getKingSquare(us) != squareOf(row, 4) ||
+      rook.getType() != PieceType::ROOK || rook.getColor() != us)
+    return Move();
+  for (int col = std::min(4, rookCol) + 1; col < std::max(4, rookCol); ++col)
+    if (!board.getPiece(row, col).isEmpty())
+      return Move();
+  for (int col = 4; col != kingCol + (kingside ? 1 : -1);
+       col += kingside ? 1 : -1)
+    if (board.isSquareAttacked(row, col, them))
+      return Move();
+  return Move(row, 4, row, kingCol);
+}
+
+// Whether the move follows the rules for its piece, leaving aside what it
+// does to its own king.
+bool isPseudoLegal(const Board &board, const Move &move) {
+  const Color us = board.getSideToMove();
+  const Piece &piece = board.getPiece(move.startRow, move.startCol);
+  const Piece &target = board.getPiece(move.endRow, move.endCol);
+  if (piece.isEmpty() || piece.getColor() != us ||
+      (!target.isEmpty() && target.getColor() == us))
+    return false;
+
+  const int from = squareOf(move.startRow, move.startCol);
+  const int to = squareOf(move.endRow, move.endCol);
+  const PieceType type = piece.getType();
+  const bool lastRank = move.endRow == 0 || move.endRow == BOARD_SIZE - 1;
+  if (type != PieceType::PAWN || !lastRank) {
+    if (move.promotionType != PieceType::NONE)
+      return false;
+  } else if (move.promotionType < PieceType::KNIGHT ||
+             move.promotionType > PieceType::QUEEN) {
+    return false;
+  }
+
+  if (type == PieceType::PAWN) {
+    const int forward = us == Color::WHITE ? 1 : -1;
+    const int rows = move.endRow - move.startRow;
+    if (move.startCol != move.endCol) {
+      const int enPassantRow = us == Color::WHITE ? 5 : 2;
+      return rows == forward && std::abs(move.endCol - move.startCol) == 1 &&
+             (!target.isEmpty() || (move.endRow == enPassantRow &&
+                                    move.endCol == board.getEnPassantCol()));
+    }
+    const int startRow = us == Color::WHITE ? 1 : BOARD_SIZE - 2;
+    return target.isEmpty() &&
+           (rows == forward ||
+            (rows == 2 * forward && move.startRow == startRow &&
+             board.getPiece(move.startRow + forward, move.startCol)
+                 .isEmpty()));
+  }
+  if (type == PieceType::KING && std::abs(move.endCol - move.startCol) == 2)
+    return castlingMove(board, move.endCol > move.startCol) == move;
+  return (attackersOf(board, us, type, to) >> from) & 1;
+}
+
+// SAN without the check or mate mark.
+std::string sanBody(Board &board, const Move &move) {
+  const Piece piece = board.getPiece(move.startRow, move.startCol);
+  const PieceType type = piece.getType();
+  if (type == PieceType::KING && std::abs(move.endCol - move.startCol) == 2)
+    return move.endCol > move.startCol ? "O-O" : "O-O-O";
+
+  const bool capture =
+      !board.getPiece(move.endRow, move.endCol).isEmpty() ||
+      (type == PieceType::PAWN && move.startCol != move.endCol);
+  std::string san;
+  if (type == PieceType::PAWN) {
+    if (capture)
+      san += static_cast<char>('a' + move.startCol);
+  } else {
+    san += SAN_LETTERS[static_cast<int>(type)];
+    // Name the file, else the rank, else both, of the moving piece when
+    // another piece of the same kind can legally reach the same square.
+    Bitboard others =
+        attackersOf(board, piece.getColor(), type,
+                    squareOf(move.endRow, move.endCol)) &
+        ~squareBit(move.startRow, move.startCol);
+    bool ambiguous = false, sameFile = false, sameRank = false;
+    while (others) {
+      const int square = popLsb(others);
+      const int row = square / BOARD_SIZE, col = square % BOARD_SIZE;
+      if (!isLegal(board, Move(row, col, move.endRow, move.endCol)))
+        continue;
+      ambiguous = true;
+      sameFile |= col == move.startCol;
+      sameRank |= row == move.startRow;
+    }
+    if (ambiguous && (!sameFile || sameRank))
+      san += static_cast<char>('a' + move.startCol);
+    if (ambiguous && sameFile)
+      san += static_cast<char>('1' + move.startRow);
+  }
+  if (capture)
+    san += 'x';
+  san += static_cast<char>('a' + move.endCol);
+  san += static_cast<char>('1' + move.endRow);
+  if (move.promotionType != PieceType::NONE) {
+    san += '=';
+    san += SAN_LETTERS[static_cast<int>(move.promotionType)];
+  }
+  return san;
+}
+
+PieceType sanPieceType(char letter) {
+  for (int type = static_cast<int>(PieceType::KNIGHT);
+       type <= static_cast<int>(PieceType::KING); ++type)
+    if (SAN_LETTERS[type] == letter)
+      return static_cast<PieceType>(type);
+  return PieceType::NONE;
+}
+
+bool isFile(char c) { return c >= 'a' && c < 'a' + BOARD_SIZE; }
+bool isRank(char c) { return c >= '1' && c < '1' + BOARD_SIZE; }
+
+} // namespace
+
+std::string moveToUci(const Move &move) {
+  std::string text = {static_cast<char>('a' + move.startCol),
+                      static_cast<char>('1' + move.startRow),
+                      static_cast<char>('a' + move.endCol),
+                      static_cast<char>('1' + move.endRow)};
+  if (move.promotionType != PieceType::NONE)
+    text += PROMOTION_LETTERS[static_cast<int>(move.promotionType) -
+                              static_cast<int>(PieceType::KNIGHT)];
+  return text;
+}
+
+Move parseUciMove(Board &board, std::string_view text) {
+  if ((text.size() != 4 && text.size() != 5) || !isFile(text[0]) ||
+      !isRank(text[1]) || !isFile(text[2]) || !isRank(text[3]))
+    return Move();
+  PieceType promotion = PieceType::NONE;
+  if (text.size() == 5) {
+    const char *letter =
+        std::char_traits<char>::find(PROMOTION_LETTERS, 4, text[4]);
+    if (!letter)
+      return Move();
+    promotion = static_cast<PieceType>(static_cast<int>(PieceType::KNIGHT) +
+                                       (letter - PROMOTION_LETTERS));
+  }
+  const Move move(text[1] - '1', text[0] - 'a', text[3] - '1', text[2] - 'a',
+                  promotion);
+  return isPseudoLegal(board, move) && isLegal(board, move) ? move : Move();
+}
+
+std::string moveToSan(Board &board, const Move &move) {
+  std::string san = sanBody(board, move);
+  board.makeMove(move);
+  if (board.isInCheck(board.getSideToMove()))
+    san += hasLegalMove(board) ? '+' : '#';
+  board.unmakeMove(move);
+  return san;
+}
+
+Move parseSanMove(Board &board, std::string_view text) {
+  while (!text.empty() && (text.back() == '+' || text.back() == '#' ||
+                           text.back() == '!' || text.back() == '?'))
+    text.remove_suffix(1);
+  if (text == "O-O" || text == "0-0")
+    return castlingMove(board, true);
+  if (text == "O-O-O" || text == "0-0-0")
+    return castlingMove(board, false);
+
+  // [piece] [from file] [from rank] [x] to-square [[=] promotion]
+  PieceType type = PieceType::PAWN;
+  if (!text.empty() && sanPieceType(text.front()) != PieceType::NONE) {
+    type = sanPieceType(text.front());
+    text.remove_prefix(1);
+  }
+  PieceType promotion = PieceType::NONE;
+  if (!text.empty() && sanPieceType(text.back()) != PieceType::NONE) {
+    promotion = sanPieceType(text.back());
+    text.remove_suffix(1);
+    if (!text.empty() && text.back() == '=')
+      text.remove_suffix(1);
+  }
+  if (text.size() < 2 || !isFile(text[text.size() - 2]) ||
+      !isRank(text.back()))
+    return Move();
+  const int toRow = text.back() - '1', toCol = text[text.size() - 2] - 'a';
+  text.remove_suffix(2);
+  if (!text.empty() && text.back() == 'x')
+    text.remove_suffix(1);
+  int fromCol = -1, fromRow = -1;
+  if (!text.empty() && isFile(text.front())) {
+    fromCol = text.front() - 'a';
+    text.remove_prefix(1);
+  }
+  if (!text.empty() && isRank(text.front())) {
+    fromRow = text.front() - '1';
+    text.remove_prefix(1);
+  }
+  if (!text.empty())
+    return Move();
+
+  const Color us = board.getSideToMove();
+  Bitboard candidates;
+  if (type == PieceType::PAWN) {
+    // A pawn comes from the file it names, else straight from behind.
+    const int forward = us == Color::WHITE ? 1 : -1;
+    const int behind = toRow - forward;
+    if (behind < 0 || behind >= BOARD_SIZE)
+      return Move();
+    const Bitboard pawns = board.getPieces(us, PieceType::PAWN);
+    if (fromCol >= 0 && fromCol != toCol) {
+      candidates = squareBit(behind, fromCol);
+    } else {
+      candidates = squareBit(behind, toCol);
+      const int twoBehind = behind - forward;
+      if (!(pawns & candidates) && twoBehind >= 0 && twoBehind < BOARD_SIZE)
+        candidates = squareBit(twoBehind, toCol);
+    }
+    candidates &= pawns;
+  } else {
+    candidates = attackersOf(board, us, type, squareOf(toRow, toCol));
+  }
+  if (fromCol >= 0)
+    candidates &= fileMask(fromCol);
+  if (fromRow >= 0)
+    candidates &= rankMask(fromRow);
+
+  // Exactly one candidate may move there legally.
+  Move found;
+  int matches = 0;
+  while (candidates) {
+    const int square = popLsb(candidates);
+    const Move move(square / BOARD_SIZE, square % BOARD_SIZE, toRow, toCol,
+                    promotion);
+    if (isPseudoLegal(board, move) && isLegal(board, move)) {
+      found = move;
+      ++matches;
+    }
+  }
+  return matches == 1 ? found : Move();
+}
+
+} // namespace chess
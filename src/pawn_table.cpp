@@ -0,0 +1,117 @@
+#include "pawn_table.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+namespace chess {
+
+namespace {
+
+constexpr int DOUBLED_MG = -10, DOUBLED_EG = -25;
+constexpr int ISOLATED_MG = -5, ISOLATED_EG = -15;
+constexpr int BACKWARD_MG = -8, BACKWARD_EG = -12;
+// Passed pawn bonus by relative rank, on top of the piece-square tables.
+constexpr int PASSED_MG[BOARD_SIZE] = {0, 2, 5, 10, 25, 50, 80, 0};
+constexpr int PASSED_EG[BOARD_SIZE] = {0, 10, 15, 25, 45, 80, 120, 0};
+// Shelter by distance of the nearest own pawn in front of the king on each
+// of its three files; index 0 means no pawn within reach.
+constexpr int SHELTER[4] = {-20, 15, 8, 2};
+
+int relativeRow(Color color, int row) {
+  return color == Color::WHITE ? row : BOARD_SIZE - 1 - row;
+}
+
+// Pawn-only terms for one side, from that side's point of view.
+void evaluatePawns(const Board &board, Color us, PawnEntry &entry, int &mg,
+                   int &eg) {
+  const Bitboard ours = board.getPawns(us);
+  const Bitboard theirs = board.getPawns(opposite(us));
+  const Bitboard theirAttacks = pawnAttacks(opposite(us), theirs);
+
+  for (Bitboard pawns = ours; pawns;) {
+    int square = popLsb(pawns);
+    int row = square / BOARD_SIZE, col = square % BOARD_SIZE;
+    Bitboard front = forwardRanksMask(us, row);
+    Bitboard adjacent = adjacentFilesMask(col);
+
+    if (ours & front & fileMask(col)) {
+      mg += DOUBLED_MG;
+      eg += DOUBLED_EG;
+    }
+
+    if (!(ours & adjacent)) {
+      mg += ISOLATED_MG;
+      eg += ISOLATED_EG;
+    } else if (!(ours & adjacent & ~front)) {
+      // No neighbour level or behind can ever support it, and an enemy
+      // pawn already guards the square it needs to advance to.
+      int stopRow = us == Color::WHITE ? row + 1 : row - 1;
+      if (stopRow >= 0 && stopRow < BOARD_SIZE &&
+          (theirAttacks & squareBit(stopRow, col))) {
+        mg += BACKWARD_MG;
+        eg += BACKWARD_EG;
+      }
+    }
+
+    if (!(theirs & front & (fileMask(col) | adjacent)) &&
+        !(ours & front & fileMask(col))) {
+      entry.passedPawns[static_cast<int>(us)] |= squareBit(row, col);
+      mg += PASSED_MG[relativeRow(us, row)];
+      eg += PASSED_EG[relativeRow(us, row)];
+    }
+  }
+}
+
+} // namespace
+
+PawnTable::PawnTable() : entries_(ENTRY_COUNT) {}
+
+PawnEntry &PawnTable::probe(const Board &board) {
+  uint64_t key = board.getPawnKey();
+  PawnEntry &entry = entries_[key & (ENTRY_COUNT - 1)];
+  if (entry.key == key)
+    return entry;
+
+  entry = PawnEntry();
+  entry.key = key;
+  int whiteMg = 0, whiteEg = 0, blackMg = 0, blackEg = 0;
+  evaluatePawns(board, Color::WHITE, entry, whiteMg, whiteEg);
+  evaluatePawns(board, Color::BLACK, entry, blackMg, blackEg);
+  entry.midgameScore = static_cast<int16_t>(whiteMg - blackMg);
+  entry.endgameScore = static_cast<int16_t>(whiteEg - blackEg);
+  return entry;
+}
+
+int PawnTable::shelter(PawnEntry &entry, const Board &board,
+                       Color color) const {
+  const int side = static_cast<int>(color);
+  const int kingSquare = board.getKingSquare(color);
+  if (kingSquare < 0)
+    return 0;
+  if (entry.shelterKingSquare[side] == kingSquare)
+    return entry.shelter[side];
+
+  const int row = kingSquare / BOARD_SIZE, col = kingSquare % BOARD_SIZE;
+  const Bitboard front = forwardRanksMask(color, row);
+  const Bitboard ours = board.getPawns(color);
+  int score = 0;
+  for (int file = std::max(col - 1, 0);
+       file <= std::min(col + 1, BOARD_SIZE - 1); ++file) {
+    Bitboard shield = ours & front & fileMask(file);
+    int distance = 0;
+    if (shield) {
+      int nearest = color == Color::WHITE ? lsb(shield) : msb(shield);
+      distance = std::abs(nearest / BOARD_SIZE - row);
+    }
+    score += SHELTER[distance < 4 ? distance : 0];
+  }
+
+  entry.shelterKingSquare[side] = static_cast<int8_t>(kingSquare);
+  entry.shelter[side] = static_cast<int16_t>(score);
+  return score;
+}
+
+void PawnTable::clear() {
+  std::fill(entries_.begin(), entries_.end(), PawnEntry());
+}
+
+} // namespace chess
@@ -0,0 +1,190 @@
+#include "pgn.hpp"
+#include "notation.hpp"
+#include <algorithm>
+
+namespace chess {
+
+namespace {
+
+constexpr std::string_view START_FEN =
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+bool isBlank(std::string_view line) {
+  for (char c : line)
+    if (!isSpace(c))
+      return false;
+  return true;
+}
+
+// Offset just past the end of the line containing pos.
+size_t lineEnd(std::string_view text, size_t pos) {
+  size_t end = text.find('\n', pos);
+  return end == std::string_view::npos ? text.size() : end + 1;
+}
+
+bool isResult(std::string_view token) {
+  return token == "1-0" || token == "0-1" || token == "1/2-1/2" ||
+         token == "*";
+}
+
+// Start of the first game that begins at or after pos: a tag line that
+// follows a blank line.
+size_t nextGameStart(std::string_view text, size_t pos) {
+  for (size_t at = text.find("\n[", pos); at != std::string_view::npos;
+       at = text.find("\n[", at + 1)) {
+    size_t previous = at == 0 ? std::string_view::npos
+                              : text.rfind('\n', at - 1);
+    size_t lineStart = previous == std::string_view::npos ? 0 : previous + 1;
+    if (isBlank(text.substr(lineStart, at - lineStart)))
+      return at + 1;
+  }
+  return text.size();
+}
+
+} // namespace
+
+std::string_view PgnGame::tag(std::string_view name) const {
+  for (size_t pos = 0; pos < tags.size(); pos = lineEnd(tags, pos)) {
+    size_t open = tags.find_first_not_of(" \t", pos);
+    if (open == std::string_view::npos || tags[open] != '[' ||
+        tags.compare(open + 1, name.size(), name) != 0)
+      continue;
+    size_t quote = open + 1 + name.size();
+    while (quote < tags.size() && (tags[quote] == ' ' || tags[quote] == '\t'))
+      ++quote;
+    if (quote >= tags.size() || tags[quote] != '"')
+      continue;
+    size_t close = quote + 1;
+    while (close < tags.size() && tags[close] != '"' && tags[close] != '\n')
+      close += tags[close] == '\\' ? 2 : 1;
+    return tags.substr(quote + 1, std::min(close, tags.size()) - quote - 1);
+  }
+  return {};
+}
+
+PgnReader::PgnReader(std::string_view text) : text_(text) {
+  if (text_.substr(0, 3) == "\xEF\xBB\xBF") // UTF-8 byte order mark
+    text_.remove_prefix(3);
+}
+
+bool PgnReader::next(PgnGame &game) {
+  size_t pos = 0;
+  while (pos < text_.size() && isSpace(text_[pos]))
+    ++pos;
+  if (pos == text_.size()) {
+    text_ = {};
+    return false;
+  }
+
+  size_t tagsEnd = pos;
+  while (tagsEnd < text_.size() && text_[tagsEnd] == '[')
+    tagsEnd = lineEnd(text_, tagsEnd);
+  game.tags = text_.substr(pos, tagsEnd - pos);
+
+  // Movetext runs to the next line opening with a tag. Comments may span
+  // lines, and a wrapped one may start a line with '[' (e.g. [%clk ...]).
+  size_t end = tagsEnd;
+  bool lineStart = true, inComment = false;
+  for (; end < text_.size(); ++end) {
+    const char c = text_[end];
+    if (inComment) {
+      inComment = c != '}';
+    } else if (c == '{') {
+      inComment = true;
+    } else if (c == '[' && lineStart && end > tagsEnd) {
+      break;
+    }
+    if (c == '\n')
+      lineStart = true;
+    else if (!isSpace(c))
+      lineStart = false;
+  }
+  game.movetext = text_.substr(tagsEnd, end - tagsEnd);
+  text_.remove_prefix(end);
+  return true;
+}
+
+bool replayPgnGame(const PgnGame &game, Board &board,
+                   const PgnMoveCallback &onMove) {
+  const std::string_view fen = game.tag("FEN");
+  if (!board.fromFEN(fen.empty() ? START_FEN : fen))
+    return false;
+
+  const std::string_view text = game.movetext;
+  int variationDepth = 0;
+  size_t pos = 0;
+  while (pos < text.size()) {
+    const char c = text[pos];
+    if (isSpace(c)) {
+      ++pos;
+    } else if (c == '{') {
+      size_t close = text.find('}', pos);
+      pos = close == std::string_view::npos ? text.size() : close + 1;
+    } else if (c == ';' || (c == '%' && (pos == 0 || text[pos - 1] == '\n'))) {
+      pos = lineEnd(text, pos); // Comment or escape to the end of the line
+    } else if (c == '(') {
+      ++variationDepth;
+      ++pos;
+    } else if (c == ')') {
+      variationDepth -= variationDepth > 0;
+      ++pos;
+    } else {
+      size_t end = pos;
+      while (end < text.size() && !isSpace(text[end]) &&
+             text[end] != '{' && text[end] != '(' && text[end] != ')' &&
+             text[end] != ';')
+        ++end;
+      std::string_view token = text.substr(pos, end - pos);
+      pos = end;
+      if (variationDepth > 0 || token[0] == '$' || token[0] == '!' ||
+          token[0] == '?')
+        continue;
+      if (isResult(token))
+        return true;
+
+      // Move numbers ("12." or "12...") may be glued to the move, and some
+      // archives write them bare ("12").
+      size_t digits = 0;
+      while (digits < token.size() && token[digits] >= '0' &&
+             token[digits] <= '9')
+        ++digits;
+      if (digits == token.size())
+        continue;
+      if (digits > 0 && token[digits] == '.') {
+        token.remove_prefix(digits);
+        while (!token.empty() && token.front() == '.')
+          token.remove_prefix(1);
+      }
+      if (token.empty())
+        continue;
+
+      Move move = parseSanMove(board, token);
+      if (move == Move())
+        return false;
+      if (!onMove(board, move))
+        return true;
+      board.makeMove(move);
+    }
+  }
+  return true;
+}
+
+std::vector<std::string_view> splitPgn(std::string_view text, int parts) {
+  std::vector<std::string_view> pieces;
+  size_t start = 0;
+  for (int i = 1; i <= parts && start < text.size(); ++i) {
+    size_t end = i == parts ? text.size()
+                            : nextGameStart(text, std::max(
+                                  start, text.size() / parts * i));
+    if (end > start)
+      pieces.push_back(text.substr(start, end - start));
+    start = end;
+  }
+  return pieces;
+}
+
+} // namespace chess
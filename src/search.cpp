@@ -0,0 +1,707 @@
+#include "search.hpp"
+#include "see.hpp"
+#include "syzygy.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace chess {
+
+namespace {
+
+// Ordering bands: TT move, winning captures, killers, quiets by history,
+// then captures that lose material.
+constexpr int TT_MOVE_SCORE = 1000000;
+constexpr int CAPTURE_SCORE = 100000;
+constexpr int KILLER_SCORE = 90000;
+constexpr int MAX_HISTORY_BONUS = 1500;
+constexpr int DELTA_MARGIN = 200;
+constexpr int ASPIRATION_DELTA = 25;
+constexpr int ASPIRATION_MIN_DEPTH = 4;
+constexpr int RFP_MAX_DEPTH = 7;
+constexpr int RFP_MARGIN = 80;
+constexpr int RAZOR_MAX_DEPTH = 3;
+constexpr int RAZOR_MARGIN = 450;
+constexpr int RAZOR_DEPTH_MARGIN = 250;
+constexpr int NULL_MOVE_MIN_DEPTH = 3;
+constexpr int LMR_MIN_DEPTH = 3;
+constexpr int LMR_HISTORY_DIVISOR = 8192;
+constexpr int MAX_QUIETS_TRACKED = 64;
+constexpr int IIR_MIN_DEPTH = 4;
+constexpr int SINGULAR_MIN_DEPTH = 8;
+constexpr int SINGULAR_TT_DEPTH_MARGIN = 3;
+
+// Late move reductions by [depth][move number], filled at startup.
+using ReductionTable = std::array<std::array<int, 64>, 64>;
+const ReductionTable REDUCTIONS = [] {
+  ReductionTable table{};
+  for (int depth = 1; depth < 64; ++depth)
+    for (int moveNumber = 1; moveNumber < 64; ++moveNumber)
+      table[depth][moveNumber] = static_cast<int>(
+          0.75 + std::log(depth) * std::log(moveNumber) / 2.25);
+  return table;
+}();
+
+// Mate and tablebase scores are stored relative to the node so they stay
+// valid when the same position is reached at a different ply.
+int scoreToTT(int score, int ply) {
+  if (score >= VALUE_TB_WIN_IN_MAX_PLY)
+    return score + ply;
+  if (score <= -VALUE_TB_WIN_IN_MAX_PLY)
+    return score - ply;
+  return score;
+}
+
+int scoreFromTT(int score, int ply) {
+  if (score >= VALUE_TB_WIN_IN_MAX_PLY)
+    return score - ply;
+  if (score <= -VALUE_TB_WIN_IN_MAX_PLY)
+    return score + ply;
+  return score;
+}
+
+int pieceCount(const Board &board) {
+  return popCount(board.getOccupied(Color::WHITE) |
+                  board.getOccupied(Color::BLACK));
+}
+
+bool isCapture(const Board &board, const Move &move) {
+  if (!board.getPiece(move.endRow, move.endCol).isEmpty())
+    return true;
+  return board.getPiece(move.startRow, move.startCol).getType() ==
+             PieceType::PAWN &&
+         move.startCol != move.endCol;
+}
+
+int historyBonus(int depth) {
+  return std::min(300 * depth - 250, MAX_HISTORY_BONUS);
+}
+
+} // namespace
+
+Search::Search(TranspositionTable &tt)
+    : tt_(tt), pvTable_(MAX_PLY + 1),
+      history_(std::make_unique<HistoryTables>()) {
+  history_->clear();
+}
+
+void Search::stop() { stopped_.store(true, std::memory_order_relaxed); }
+
+// Time spent pondering counts against the move, so a long ponder may make
+// the search stop right away.
+void Search::ponderHit() { pondering_.store(false, std::memory_order_relaxed); }
+
+void Search::setInfoCallback(InfoCallback callback) {
+  infoCallback_ = std::move(callback);
+}
+
+void Search::clear() {
+  history_->clear();
+  evaluator_.clear();
+}
+
+uint64_t Search::getNodes() const { return nodes_; }
+
+SearchResult Search::think(Board &board, const SearchLimits &limits) {
+  limits_ = limits;
+  stopped_.store(false, std::memory_order_relaxed);
+  pondering_.store(limits.ponder, std::memory_order_relaxed);
+  nodes_ = 0;
+  tbHits_ = 0;
+  timeManager_.start(limits, board.getSideToMove());
+  for (auto &from : rootEffort_)
+    from.fill(0);
+  stack_.fill(StackEntry());
+  history_->clearKillers();
+  evaluator_.resetCacheCounters();
+  if (limits.newSearch)
+    tt_.newSearch();
+  rankRootMoves(board);
+
+  SearchResult result;
+  int maxDepth = std::clamp(limits.depth, 1, MAX_PLY - 1);
+  int previousScore = 0;
+  int bestMoveStability = 0;
+  for (int depth = 1; depth <= maxDepth; ++depth) {
+    // Aspiration window around the previous score, widened gradually on
+    // either side until the result falls inside it.
+    int delta = ASPIRATION_DELTA;
+    int alpha = -VALUE_INFINITE;
+    int beta = VALUE_INFINITE;
+    if (depth >= ASPIRATION_MIN_DEPTH) {
+      alpha = std::max(previousScore - delta, -VALUE_INFINITE);
+      beta = std::min(previousScore + delta, VALUE_INFINITE);
+    }
+
+    int score;
+    while (true) {
+      score = alphaBeta(board, alpha, beta, depth, 0, false);
+      if (stopped_.load(std::memory_order_relaxed))
+        break;
+      if (score <= alpha) {
+        beta = (alpha + beta) / 2;
+        alpha = std::max(score - delta, -VALUE_INFINITE);
+      } else if (score >= beta) {
+        beta = std::min(score + delta, VALUE_INFINITE);
+      } else {
+        break;
+      }
+      delta += delta / 2;
+    }
+    if (stopped_.load(std::memory_order_relaxed) && depth > 1)
+      break; // Keep the last fully searched iteration
+
+    int scoreDrop = depth > 1 ? previousScore - score : 0;
+    previousScore = score;
+
+    Move previousBest = result.bestMove;
+    result.score = rootInTb_ && std::abs(score) < VALUE_MATE_IN_MAX_PLY
+                       ? rootTbScore_
+                       : score;
+    result.depth = depth;
+    result.pv.assign(pvTable_[0].begin(), pvTable_[0].begin() + pvLength_[0]);
+    if (!result.pv.empty())
+      result.bestMove = result.pv.front();
+    if (stopped_.load(std::memory_order_relaxed))
+      break;
+    if (infoCallback_) {
+      result.nodes = nodes_;
+      result.tbHits = tbHits_;
+      result.time = timeManager_.elapsed();
+      infoCallback_(result);
+    }
+
+    bestMoveStability =
+        result.bestMove == previousBest ? bestMoveStability + 1 : 0;
+    const Move &best = result.bestMove;
+    double bestMoveNodeShare =
+        nodes_ ? static_cast<double>(
+                     rootEffort_[squareIndex(best.startRow, best.startCol)]
+                                [squareIndex(best.endRow, best.endCol)]) /
+                     nodes_
+               : 0.0;
+    if (!pondering_.load(std::memory_order_relaxed) &&
+        timeManager_.shouldStopIteration(bestMoveStability, scoreDrop,
+                                         bestMoveNodeShare))
+      break;
+  }
+
+  // Stopped before depth 1 finished: fall back to any legal move.
+  if (result.pv.empty()) {
+    MoveList moves;
+    moveGen_.generateMoves(board, board.getSideToMove(), moves);
+    const std::vector<Move> &allowed = limits_.searchMoves;
+    for (const Move &move : moves) {
+      if (!allowed.empty() &&
+          std::find(allowed.begin(), allowed.end(), move) == allowed.end())
+        continue;
+      board.makeMove(move);
+      bool legal = !board.isInCheck(opposite(board.getSideToMove()));
+      board.unmakeMove(move);
+      if (legal) {
+        result.bestMove = move;
+        result.pv.assign(1, move);
+        break;
+      }
+    }
+  }
+  result.nodes = nodes_;
+  result.tbHits = tbHits_;
+  result.time = timeManager_.elapsed();
+  result.evalCacheHits = evaluator_.getCache().getHits();
+  result.evalCacheMisses = evaluator_.getCache().getMisses();
+  return result;
+}
+
+// When the root is in the tablebases, only the moves that keep its best
+// result are searched, and the search merely chooses between them. Probing
+// inside the tree then stays off, except in a won position that could only
+// be ranked by WDL, where it still steers towards the win.
+void Search::rankRootMoves(Board &board) {
+  rootInTb_ = false;
+  const int largest = syzygy::largest();
+  tbCardinality_ = std::clamp(limits_.syzygyProbeLimit, 0, largest);
+  // Smaller tables than the limit asks for are probed at any depth.
+  tbProbeDepth_ =
+      limits_.syzygyProbeLimit > largest ? 0 : limits_.syzygyProbeDepth;
+  if (!tbCardinality_ || board.getCastlingRights() ||
+      pieceCount(board) > tbCardinality_)
+    return;
+
+  const Color us = board.getSideToMove();
+  MoveList generated;
+  moveGen_.generateMoves(board, us, generated);
+  std::vector<syzygy::RootMove> moves;
+  for (const Move &move : generated) {
+    if (!limits_.searchMoves.empty() &&
+        std::find(limits_.searchMoves.begin(), limits_.searchMoves.end(),
+                  move) == limits_.searchMoves.end())
+      continue;
+    board.makeMove(move);
+    const bool legal = !board.isInCheck(us);
+    board.unmakeMove(move);
+    if (legal)
+      moves.push_back({move});
+  }
+  if (moves.empty())
+    return;
+  const bool byDtz = syzygy::rankRootMoves(board, moves);
+  if (!byDtz && !syzygy::rankRootMovesByWdl(board, moves))
+    return;
+
+  int best = moves.front().rank;
+  for (const syzygy::RootMove &move : moves)
+    best = std::max(best, move.rank);
+  limits_.searchMoves.clear();
+  for (const syzygy::RootMove &move : moves)
+    if (move.rank == best)
+      limits_.searchMoves.push_back(move.move);
+
+  // Wins the fifty-move rule spoils get a few centipawns, more the
+  // closer they come to a real win.
+  const int bound = limits_.syzygy50MoveRule ? 900 : 1;
+  const int pawn = pieceValue(PieceType::PAWN);
+  rootTbScore_ = best >= bound  ? VALUE_TB_WIN
+                 : best > 0     ? std::max(3, best - 800) * pawn / 200
+                 : best == 0    ? VALUE_DRAW
+                 : best > -bound ? std::min(-3, best + 800) * pawn / 200
+                                 : -VALUE_TB_WIN;
+  rootInTb_ = true;
+  if (byDtz || rootTbScore_ <= VALUE_DRAW)
+    tbCardinality_ = 0;
+}
+
+bool Search::shouldStop() {
+  // The node limit is exact; the clock is polled every 1024 nodes to keep
+  // it off the hot path.
+  if ((limits_.nodes && nodes_ >= limits_.nodes) ||
+      ((nodes_ & 1023) == 0 && !pondering_.load(std::memory_order_relaxed) &&
+       timeManager_.hardLimitReached()))
+    stopped_.store(true, std::memory_order_relaxed);
+  return stopped_.load(std::memory_order_relaxed);
+}
+
+void Search::updatePv(int ply, const Move &move) {
+  pvTable_[ply][ply] = move;
+  for (int i = ply + 1; i < pvLength_[ply + 1]; ++i)
+    pvTable_[ply][i] = pvTable_[ply + 1][i];
+  pvLength_[ply] = std::max(pvLength_[ply + 1], ply + 1);
+}
+
+void Search::scoreMoves(const Board &board, const MoveList &moves, int *scores,
+                        const Move &ttMove, int ply) const {
+  const auto &killers = history_->killers[ply];
+  for (int i = 0; i < moves.size(); ++i) {
+    const Move &move = moves[i];
+    if (move == ttMove) {
+      scores[i] = TT_MOVE_SCORE;
+    } else if (isCapture(board, move) ||
+               move.promotionType != PieceType::NONE) {
+      // MVV-LVA: most valuable victim first, cheapest attacker breaks ties.
+      PieceType victim = board.getPiece(move.endRow, move.endCol).getType();
+      PieceType attacker =
+          board.getPiece(move.startRow, move.startCol).getType();
+      int mvvLva = 10 * pieceValue(victim) + pieceValue(move.promotionType) -
+                   static_cast<int>(attacker);
+      scores[i] = (seeGe(board, move, 0) ? CAPTURE_SCORE : -CAPTURE_SCORE) +
+                  mvvLva;
+    } else if (move == killers[0]) {
+      scores[i] = KILLER_SCORE;
+    } else if (move == killers[1]) {
+      scores[i] = KILLER_SCORE - 1;
+    } else {
+      scores[i] = quietScore(board, move, ply);
+    }
+  }
+}
+
+int Search::quietScore(const Board &board, const Move &move, int ply) const {
+  const Piece &piece = board.getPiece(move.startRow, move.startCol);
+  int piece12 = pieceIndex(piece.getColor(), piece.getType());
+  int to = squareIndex(move.endRow, move.endCol);
+  int score = history_->butterfly[static_cast<int>(piece.getColor())]
+                                 [squareIndex(move.startRow, move.startCol)]
+                                 [to];
+  for (int back = 1; back <= 2 && back <= ply; ++back)
+    if (const PieceToHistory *context =
+            stack_[ply - back].continuationHistory)
+      score += (*context)[piece12][to];
+  return score;
+}
+
+void Search::updateQuietStats(const Board &board, int ply, int depth,
+                              const Move &bestMove, const Move *quiets,
+                              int quietCount) {
+  history_->storeKiller(ply, bestMove);
+
+  // Reward the cutoff move and penalise the quiets tried before it.
+  int bonus = historyBonus(depth);
+  for (int i = 0; i < quietCount; ++i) {
+    const Move &move = quiets[i];
+    const Piece &piece = board.getPiece(move.startRow, move.startCol);
+    int piece12 = pieceIndex(piece.getColor(), piece.getType());
+    int to = squareIndex(move.endRow, move.endCol);
+    int delta = move == bestMove ? bonus : -bonus;
+    updateHistory(history_->butterfly[static_cast<int>(piece.getColor())]
+                                     [squareIndex(move.startRow,
+                                                  move.startCol)][to],
+                  delta);
+    for (int back = 1; back <= 2 && back <= ply; ++back)
+      if (PieceToHistory *context = stack_[ply - back].continuationHistory)
+        updateHistory((*context)[piece12][to], delta);
+  }
+}
+
+const Move &Search::pickMove(MoveList &moves, int *scores, int index) {
+  int best = index;
+  for (int i = index + 1; i < moves.size(); ++i)
+    if (scores[i] > scores[best])
+      best = i;
+  std::swap(moves[index], moves[best]);
+  std::swap(scores[index], scores[best]);
+  return moves[index];
+}
+
+int Search::alphaBeta(Board &board, int alpha, int beta, int depth, int ply,
+                      bool cutNode) {
+  pvLength_[ply] = ply;
+  if (depth <= 0)
+    return quiescence(board, alpha, beta, ply);
+
+  ++nodes_;
+  if (shouldStop())
+    return 0;
+
+  const Color us = board.getSideToMove();
+  const bool rootNode = ply == 0;
+  const bool pvNode = beta - alpha > 1;
+  if (!rootNode) {
+    if (board.isDraw())
+      return VALUE_DRAW;
+    if (ply >= MAX_PLY - 1)
+      return evaluator_.evaluate(board);
+
+    // Mate distance pruning
+    alpha = std::max(alpha, -VALUE_MATE + ply);
+    beta = std::min(beta, VALUE_MATE - ply - 1);
+    if (alpha >= beta)
+      return alpha;
+  }
+
+  StackEntry &ss = stack_[ply];
+  const Move excludedMove = ss.excludedMove;
+  const bool excluded = excludedMove != Move();
+
+  TTEntry ttEntry{};
+  bool ttHit = tt_.probe(board.getHash(), ttEntry);
+  Move ttMove = ttHit ? Move::unpack(ttEntry.move) : Move();
+  int ttScore = ttHit ? scoreFromTT(ttEntry.score, ply) : 0;
+  // Cut only at non-PV nodes so the principal variation stays intact. The
+  // entry belongs to the full node, so it cannot answer an exclusion search.
+  if (ttHit && !pvNode && !excluded && ttEntry.depth >= depth) {
+    if (ttEntry.bound == Bound::EXACT ||
+        (ttEntry.bound == Bound::LOWER && ttScore >= beta) ||
+        (ttEntry.bound == Bound::UPPER && ttScore <= alpha))
+      return ttScore;
+  }
+
+  // Tablebase probe, once a capture or pawn move has brought the position
+  // into the tables. Wins and losses are bounds, as the search may still
+  // find a mate.
+  if (!rootNode && !excluded && tbCardinality_ &&
+      board.getHalfmoveClock() == 0 && !board.getCastlingRights()) {
+    const int pieces = pieceCount(board);
+    int wdl;
+    if ((pieces < tbCardinality_ ||
+         (pieces == tbCardinality_ && depth >= tbProbeDepth_)) &&
+        syzygy::probeWdl(board, wdl)) {
+      ++tbHits_;
+      const int drawScore = limits_.syzygy50MoveRule ? 1 : 0;
+      const int score = wdl < -drawScore  ? -VALUE_TB_WIN + ply
+                        : wdl > drawScore ? VALUE_TB_WIN - ply
+                                          : VALUE_DRAW + 2 * wdl * drawScore;
+      const Bound bound = wdl < -drawScore  ? Bound::UPPER
+                          : wdl > drawScore ? Bound::LOWER
+                                            : Bound::EXACT;
+      if (bound == Bound::EXACT ||
+          (bound == Bound::LOWER ? score >= beta : score <= alpha)) {
+        tt_.store(board.getHash(), std::min(depth + 6, MAX_PLY - 1),
+                  scoreToTT(score, ply), 0, bound, Move().pack());
+        return score;
+      }
+    }
+  }
+
+  const bool inCheck = board.isInCheck(us);
+  if (inCheck)
+    ++depth; // Check extension
+
+  ss.nullMove = false;
+  ss.staticEval = inCheck ? -VALUE_INFINITE : evaluator_.evaluate(board);
+  const int staticEval = ss.staticEval;
+
+  // Internal iterative reduction: without a TT move the ordering is poor
+  // and the node was not worth storing before, so search it a ply shallower.
+  if ((pvNode || cutNode) && !excluded && depth >= IIR_MIN_DEPTH &&
+      ttMove == Move())
+    --depth;
+
+  if (!pvNode && !inCheck && !excluded) {
+    // Reverse futility pruning: far enough above beta that a shallow search
+    // is not expected to bring the score back down.
+    if (depth <= RFP_MAX_DEPTH && staticEval - RFP_MARGIN * depth >= beta &&
+        staticEval < VALUE_MATE_IN_MAX_PLY)
+      return staticEval;
+
+    // Razoring: hopeless shallow nodes drop straight into quiescence. Not
+    // against a mate bound, which quiescence cannot prove or refute.
+    if (depth <= RAZOR_MAX_DEPTH && std::abs(alpha) < VALUE_MATE_IN_MAX_PLY &&
+        staticEval + RAZOR_MARGIN + RAZOR_DEPTH_MARGIN * depth * depth <=
+            alpha) {
+      int score = quiescence(board, alpha, alpha + 1, ply);
+      if (score <= alpha)
+        return score;
+    }
+
+    // Null-move pruning: if passing still fails high, a real move will too.
+    // Skipped without pieces, where zugzwang makes passing unsound.
+    if (!rootNode && depth >= NULL_MOVE_MIN_DEPTH && staticEval >= beta &&
+        !stack_[ply - 1].nullMove && board.hasNonPawnMaterial(us) &&
+        beta > -VALUE_MATE_IN_MAX_PLY) {
+      int reduction = 3 + depth / 4 + std::min((staticEval - beta) / 200, 3);
+      ss.nullMove = true;
+      ss.currentMove = Move();
+      ss.continuationHistory = nullptr;
+      board.makeNullMove();
+      int score = -alphaBeta(board, -beta, -beta + 1, depth - reduction,
+                             ply + 1, !cutNode);
+      board.unmakeNullMove();
+      ss.nullMove = false;
+      if (stopped_.load(std::memory_order_relaxed))
+        return 0;
+      if (score >= beta)
+        return score >= VALUE_MATE_IN_MAX_PLY ? beta : score;
+    }
+  }
+
+  MoveList moves;
+  int scores[MoveList::CAPACITY];
+  moveGen_.generateMoves(board, us, moves);
+  scoreMoves(board, moves, scores, ttMove, ply);
+
+  const int originalAlpha = alpha;
+  int bestScore = -VALUE_INFINITE;
+  Move bestMove;
+  int legalMoves = 0;
+  Move quietsTried[MAX_QUIETS_TRACKED];
+  int quietCount = 0;
+
+  for (int i = 0; i < moves.size(); ++i) {
+    const Move move = pickMove(moves, scores, i);
+    if (move == excludedMove ||
+        (rootNode && !limits_.searchMoves.empty() &&
+         std::find(limits_.searchMoves.begin(), limits_.searchMoves.end(),
+                   move) == limits_.searchMoves.end()))
+      continue;
+    const bool quiet =
+        !isCapture(board, move) && move.promotionType == PieceType::NONE;
+    const Piece moved = board.getPiece(move.startRow, move.startCol);
+    const int history = quiet ? quietScore(board, move, ply) : 0;
+    const uint64_t nodesBefore = nodes_;
+    board.makeMove(move);
+    if (board.isInCheck(us)) {
+      board.unmakeMove(move);
+      continue;
+    }
+    ++legalMoves;
+
+    // Singular extension: if every alternative fails low against a margin
+    // below the TT score in a reduced search that excludes the TT move, the
+    // TT move is the only good one and gets an extra ply.
+    int extension = 0;
+    if (!rootNode && !excluded && depth >= SINGULAR_MIN_DEPTH &&
+        move == ttMove && ttEntry.bound != Bound::UPPER &&
+        ttEntry.depth >= depth - SINGULAR_TT_DEPTH_MARGIN &&
+        std::abs(ttScore) < VALUE_MATE_IN_MAX_PLY) {
+      board.unmakeMove(move);
+      int singularBeta = ttScore - 2 * depth;
+      ss.excludedMove = move;
+      int score = alphaBeta(board, singularBeta - 1, singularBeta,
+                            (depth - 1) / 2, ply, cutNode);
+      ss.excludedMove = Move();
+      board.makeMove(move);
+      if (stopped_.load(std::memory_order_relaxed)) {
+        board.unmakeMove(move);
+        return 0;
+      }
+      if (score < singularBeta)
+        extension = 1;
+    }
+
+    ss.currentMove = move;
+    ss.continuationHistory =
+        &history_->continuation[pieceIndex(moved.getColor(), moved.getType())]
+                               [squareIndex(move.endRow, move.endCol)];
+    if (quiet && quietCount < MAX_QUIETS_TRACKED)
+      quietsTried[quietCount++] = move;
+    const bool givesCheck = board.isInCheck(opposite(us));
+    const int newDepth = depth - 1 + extension;
+
+    // Principal variation search: the first move gets the full window, the
+    // rest a null window that only proves they are no better. A fail-high
+    // inside a PV node is re-searched with the full window.
+    int score;
+    if (legalMoves == 1) {
+      score = -alphaBeta(board, -beta, -alpha, newDepth, ply + 1, false);
+    } else {
+      // Late move reductions: quiet moves ordered late are unlikely to be
+      // best, so search them shallower first and verify only on fail-high.
+      int reduction = 0;
+      if (depth >= LMR_MIN_DEPTH && legalMoves > 1 + pvNode && quiet &&
+          !inCheck && !givesCheck) {
+        reduction = REDUCTIONS[std::min(depth, 63)][std::min(legalMoves, 63)];
+        reduction -= pvNode;
+        reduction += cutNode;
+        reduction -= history / LMR_HISTORY_DIVISOR;
+        reduction = std::clamp(reduction, 0, newDepth - 1);
+      }
+
+      if (reduction > 0) {
+        score = -alphaBeta(board, -alpha - 1, -alpha, newDepth - reduction,
+                           ply + 1, true);
+        if (score > alpha)
+          score = -alphaBeta(board, -alpha - 1, -alpha, newDepth, ply + 1,
+                             !cutNode);
+      } else {
+        score = -alphaBeta(board, -alpha - 1, -alpha, newDepth, ply + 1,
+                           !cutNode);
+      }
+      if (pvNode && score > alpha && score < beta)
+        score = -alphaBeta(board, -beta, -alpha, newDepth, ply + 1, false);
+    }
+    board.unmakeMove(move);
+
+    if (rootNode)
+      rootEffort_[squareIndex(move.startRow, move.startCol)]
+                 [squareIndex(move.endRow, move.endCol)] +=
+          nodes_ - nodesBefore;
+
+    if (stopped_.load(std::memory_order_relaxed))
+      return 0;
+
+    if (score > bestScore) {
+      bestScore = score;
+      if (score > alpha) {
+        alpha = score;
+        bestMove = move;
+        updatePv(ply, move);
+        if (alpha >= beta) {
+          if (quiet)
+            updateQuietStats(board, ply, depth, move, quietsTried,
+                             quietCount);
+          break;
+        }
+      }
+    }
+  }
+
+  if (legalMoves == 0) {
+    if (excluded)
+      return alpha; // Only the excluded move was playable
+    return inCheck ? -VALUE_MATE + ply : VALUE_DRAW;
+  }
+  if (excluded)
+    return bestScore;
+
+  Bound bound = bestScore >= beta            ? Bound::LOWER
+                : bestScore > originalAlpha ? Bound::EXACT
+                                            : Bound::UPPER;
+  tt_.store(board.getHash(), depth, scoreToTT(bestScore, ply), 0, bound,
+            bestMove.pack());
+  return bestScore;
+}
+
+int Search::quiescence(Board &board, int alpha, int beta, int ply) {
+  pvLength_[ply] = ply;
+  stack_[ply].continuationHistory = nullptr;
+  ++nodes_;
+  if (shouldStop())
+    return 0;
+
+  if (board.isDraw())
+    return VALUE_DRAW;
+
+  const Color us = board.getSideToMove();
+  const bool inCheck = board.isInCheck(us);
+  if (ply >= MAX_PLY - 1)
+    return inCheck ? VALUE_DRAW : evaluator_.evaluate(board);
+
+  // Stand pat: the side to move can usually do at least as well as the
+  // static evaluation by declining every capture. Not available in check,
+  // where all evasions are searched instead.
+  int bestScore = -VALUE_INFINITE;
+  int standPat = 0;
+  if (!inCheck) {
+    standPat = evaluator_.evaluate(board);
+    if (standPat >= beta)
+      return standPat;
+    alpha = std::max(alpha, standPat);
+    bestScore = standPat;
+  }
+
+  MoveList moves;
+  int scores[MoveList::CAPACITY];
+  if (inCheck)
+    moveGen_.generateMoves(board, us, moves);
+  else
+    moveGen_.generateCaptures(board, us, moves);
+  scoreMoves(board, moves, scores, Move(), ply);
+
+  int legalMoves = 0;
+  for (int i = 0; i < moves.size(); ++i) {
+    const Move move = pickMove(moves, scores, i);
+
+    if (!inCheck) {
+      // Delta pruning: even winning the victim (and promoting) cannot lift
+      // the score back to alpha.
+      int gain = pieceValue(board.getPiece(move.endRow, move.endCol).getType());
+      if (move.promotionType != PieceType::NONE)
+        gain += pieceValue(move.promotionType) - pieceValue(PieceType::PAWN);
+      else if (gain == 0)
+        gain = pieceValue(PieceType::PAWN); // en passant
+      if (standPat + gain + DELTA_MARGIN <= alpha)
+        continue;
+
+      // SEE pruning: skip captures that lose material outright.
+      if (!seeGe(board, move, 0))
+        continue;
+    }
+
+    board.makeMove(move);
+    if (board.isInCheck(us)) {
+      board.unmakeMove(move);
+      continue;
+    }
+    ++legalMoves;
+    int score = -quiescence(board, -beta, -alpha, ply + 1);
+    board.unmakeMove(move);
+
+    if (stopped_.load(std::memory_order_relaxed))
+      return 0;
+
+    if (score > bestScore) {
+      bestScore = score;
+      if (score > alpha) {
+        alpha = score;
+        updatePv(ply, move);
+        if (alpha >= beta)
+          break;
+      }
+    }
+  }
+
+  if (inCheck && legalMoves == 0)
+    return -VALUE_MATE + ply;
+  return bestScore;
+}
+
+} // namespace chess
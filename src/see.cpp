@@ -0,0 +1,88 @@
+#include "see.hpp"
+#include "evaluation.hpp"
+#include <cstdlib>
+#include <utility>
+
+namespace chess {
+
+namespace {
+
+// Least valuable piece of `side` still in `occupied` that attacks the
+// square. Sliders are found through the current occupancy, which reveals
+// x-rays as pieces are removed.
+PieceType leastValuableAttacker(const Board &board, int square, Color side,
+                                Bitboard occupied, Bitboard &attackerBit) {
+  const Bitboard diagonal = bishopAttacks(square, occupied);
+  const Bitboard straight = rookAttacks(square, occupied);
+  const std::pair<PieceType, Bitboard> reaches[] = {
+      {PieceType::PAWN, pawnAttacks(opposite(side), Bitboard(1) << square)},
+      {PieceType::KNIGHT, knightAttacks(square)},
+      {PieceType::BISHOP, diagonal},
+      {PieceType::ROOK, straight},
+      {PieceType::QUEEN, diagonal | straight},
+      {PieceType::KING, kingAttacks(square)}};
+  for (const auto &[type, reach] : reaches) {
+    const Bitboard attackers = reach & occupied & board.getPieces(side, type);
+    if (attackers) {
+      attackerBit = attackers & (~attackers + 1);
+      return type;
+    }
+  }
+  return PieceType::NONE;
+}
+
+} // namespace
+
+bool seeGe(const Board &board, const Move &move, int threshold) {
+  const Piece &moving = board.getPiece(move.startRow, move.startCol);
+  const Piece &target = board.getPiece(move.endRow, move.endCol);
+
+  // Castling, en passant and promotions are scored as an even exchange.
+  bool castling = moving.getType() == PieceType::KING &&
+                  std::abs(move.endCol - move.startCol) == 2;
+  bool enPassant = moving.getType() == PieceType::PAWN &&
+                   move.startCol != move.endCol && target.isEmpty();
+  if (castling || enPassant || move.promotionType != PieceType::NONE)
+    return 0 >= threshold;
+
+  int swap = pieceValue(target.getType()) - threshold;
+  if (swap < 0)
+    return false;
+  swap = pieceValue(moving.getType()) - swap;
+  if (swap <= 0)
+    return true;
+
+  const int square = move.endRow * BOARD_SIZE + move.endCol;
+  Bitboard occupied =
+      (board.getOccupied(Color::WHITE) | board.getOccupied(Color::BLACK)) &
+      ~(squareBit(move.startRow, move.startCol) | Bitboard(1) << square);
+
+  Color side = moving.getColor();
+  int result = 1;
+  while (true) {
+    side = opposite(side);
+    Bitboard attackerBit = 0;
+    PieceType attacker =
+        leastValuableAttacker(board, square, side, occupied, attackerBit);
+    if (attacker == PieceType::NONE)
+      break;
+    result ^= 1;
+
+    // A king can only recapture if the other side has nothing left to hit it.
+    if (attacker == PieceType::KING) {
+      Bitboard unused = 0;
+      return leastValuableAttacker(board, square, opposite(side), occupied,
+                                   unused) != PieceType::NONE
+                 ? !result
+                 : result;
+    }
+
+    swap = pieceValue(attacker) - swap;
+    if (swap < result)
+      break;
+    occupied ^= attackerBit;
+  }
+  return result;
+}
+
+} // namespace chess
@@ -0,0 +1,977 @@
+#include "syzygy.hpp"
+#include "mapped_file.hpp"
+#include "move_generator.hpp"
+#include "zobrist.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+namespace chess {
+namespace syzygy {
+
+namespace {
+
+constexpr int TB_PIECES = 7;
+constexpr int MAX_RANK = 1000;
+
+constexpr unsigned char WDL_MAGIC[4] = {0x71, 0xE8, 0x23, 0x5D};
+constexpr unsigned char DTZ_MAGIC[4] = {0xD7, 0x66, 0x0C, 0xA5};
+
+// First byte of a table.
+constexpr int HEADER_SPLIT = 1; // Separate tables for each side to move
+constexpr int HEADER_HAS_PAWNS = 2;
+
+// First byte of each sub-table.
+constexpr int FLAG_BLACK_TO_MOVE = 1; // The side a DTZ table is stored for
+constexpr int FLAG_MAPPED = 2;        // DTZ values go through a value map
+constexpr int FLAG_WIN_PLIES = 4;     // Wins counted in plies, not moves
+constexpr int FLAG_LOSS_PLIES = 8;
+constexpr int FLAG_WIDE = 16; // 16-bit value map
+constexpr int FLAG_SINGLE_VALUE = 128;
+
+constexpr const char *PIECE_LETTERS = " PNBRQK"; // Indexed by PieceType
+constexpr const char *NAME_ORDER = "QRBNP";      // As in the file names
+
+#ifdef _WIN32
+constexpr char PATH_SEPARATOR = ';';
+#else
+constexpr char PATH_SEPARATOR = ':';
+#endif
+
+// Squares are row * BOARD_SIZE + col, as in the tables.
+int rankOf(int square) { return square >> 3; }
+int fileOf(int square) { return square & 7; }
+int flipFile(int square) { return square ^ 7; }
+int flipRank(int square) { return square ^ 56; }
+int transpose(int square) { return (square >> 3 | square << 3) & 63; }
+// Positive above the a1-h8 diagonal, negative below.
+int offDiagonal(int square) { return rankOf(square) - fileOf(square); }
+bool inTriangle(int square) { // a1-d1-d4
+  return fileOf(square) < 4 && offDiagonal(square) <= 0;
+}
+
+uint64_t readLittleEndian(const unsigned char *bytes, int count) {
+  uint64_t value = 0;
+  for (int i = count - 1; i >= 0; --i)
+    value = value << 8 | bytes[i];
+  return value;
+}
+
+uint64_t readBigEndian(const unsigned char *bytes, int count) {
+  uint64_t value = 0;
+  for (int i = 0; i < count; ++i)
+    value = value << 8 | bytes[i];
+  return value;
+}
+
+int sign(int value) { return (value > 0) - (value < 0); }
+
+// Index arithmetic shared by every table. A position is encoded group by
+// group: first the leading pawns, or without pawns the kings (plus one
+// more unique piece if there is one) reduced by the board's symmetries,
+// then each further group of like pieces as a combination of the squares
+// left over.
+struct Encoding {
+  int mapPawns[64] = {};  // a2-h7 to 47..0, edge files and low ranks first
+  int mapB1H1H7[64] = {}; // Below the diagonal to 0..27
+  int mapA1D1D4[64] = {}; // The triangle to 0..9, the diagonal last
+  int mapKK[10][64] = {}; // The 462 legal placements of two kings
+  uint64_t binomial[6][64] = {}; // [k][n]: ways to choose k of n
+  uint64_t leadPawnIdx[6][64] = {};  // [lead pawns][square of the first]
+  uint64_t leadPawnsSize[6][4] = {}; // [lead pawns][file of the first]
+};
+
+const Encoding ENCODING = [] {
+  Encoding e;
+  int code = 0;
+  for (int square = 0; square < 64; ++square)
+    if (offDiagonal(square) < 0)
+      e.mapB1H1H7[square] = code++;
+
+  code = 0;
+  std::vector<int> diagonal;
+  for (int square = 0; square < 64; ++square)
+    if (inTriangle(square) && offDiagonal(square) < 0)
+      e.mapA1D1D4[square] = code++;
+    else if (inTriangle(square))
+      diagonal.push_back(square);
+  for (int square : diagonal)
+    e.mapA1D1D4[square] = code++;
+
+  // With the first king on the diagonal the second stays on or below it.
+  code = 0;
+  std::vector<std::pair<int, int>> bothOnDiagonal;
+  for (int index = 0; index < 10; ++index)
+    for (int first = 0; first < 64; ++first) {
+      if (!inTriangle(first) || e.mapA1D1D4[first] != index)
+        continue;
+      for (int second = 0; second < 64; ++second) {
+        if (second == first || (kingAttacks(first) >> second & 1) ||
+            (!offDiagonal(first) && offDiagonal(second) > 0))
+          continue;
+        if (!offDiagonal(first) && !offDiagonal(second))
+          bothOnDiagonal.emplace_back(index, second);
+        else
+          e.mapKK[index][second] = code++;
+      }
+    }
+  for (const auto &[index, second] : bothOnDiagonal)
+    e.mapKK[index][second] = code++;
+
+  e.binomial[0][0] = 1;
+  for (int n = 1; n < 64; ++n)
+    for (int k = 0; k < 6 && k <= n; ++k)
+      e.binomial[k][n] = (k > 0 ? e.binomial[k - 1][n - 1] : 0) +
+                         (k < n ? e.binomial[k][n - 1] : 0);
+
+  // The leading pawn is the one with the highest mapPawns value; the
+  // others can only stand on squares with a lower one.
+  int available = 47;
+  for (int count = 1; count <= 5; ++count)
+    for (int file = 0; file < 4; ++file) {
+      uint64_t index = 0;
+      for (int rank = 1; rank < 7; ++rank) {
+        const int square = rank * BOARD_SIZE + file;
+        if (count == 1) {
+          e.mapPawns[square] = available--;
+          e.mapPawns[flipFile(square)] = available--;
+        }
+        e.leadPawnIdx[count][square] = index;
+        index += e.binomial[count - 1][e.mapPawns[square]];
+      }
+      e.leadPawnsSize[count][file] = index;
+    }
+  return e;
+}();
+
+// One compressed sub-table: a side to move and, with pawns, the file of
+// the leading pawn. Values are canonical Huffman codes of symbols that
+// stand for one value or, by recursive pairing, for a pair of symbols.
+struct PairsData {
+  int flags = 0;
+  int minSymLen = 0; // The value itself with FLAG_SINGLE_VALUE
+  uint64_t blockSize = 0;
+  uint64_t span = 1; // Values between two sparse index entries
+  uint32_t blockCount = 0;
+  uint32_t blockLengthSize = 0; // Padded past blockCount
+  uint64_t sparseIndexSize = 0;
+  const unsigned char *lowestSym = nullptr;   // 16-bit, per code length
+  const unsigned char *tree = nullptr;        // Two 12-bit children
+  const unsigned char *sparseIndex = nullptr; // 32-bit block, 16-bit offset
+  const unsigned char *blockLength = nullptr; // 16-bit values - 1
+  const unsigned char *data = nullptr;
+  std::vector<uint64_t> base64; // Lowest code of each length, left-aligned
+  std::vector<uint8_t> symLen;  // Values a symbol stands for - 1
+  int pieces[TB_PIECES] = {};   // Encoding order, as piece codes
+  uint64_t groupIdx[TB_PIECES + 1] = {};
+  int groupLen[TB_PIECES + 1] = {}; // Zero-terminated
+  int mapIdx[4] = {}; // Value maps of win, loss, cursed win, blessed loss
+};
+
+struct Table {
+  bool dtz = false;
+  MappedFile file;
+  uint64_t key = 0;  // Material with the first side of the name as White
+  uint64_t key2 = 0; // and as Black
+  int pieceCount = 0;
+  bool hasPawns = false;
+  bool hasUniquePieces = false; // A piece that is alone of its kind
+  int pawnCount[2] = {};        // Leading side first
+  const unsigned char *map = nullptr; // DTZ value maps
+  PairsData items[2][4];              // [side to move][leading pawn file]
+
+  // DTZ tables store a single side to move.
+  PairsData &get(int stm, int file) {
+    return items[dtz ? 0 : stm][hasPawns ? file : 0];
+  }
+};
+
+struct TablePair {
+  Table wdl;
+  Table dtz; // Closed when the .rtbz file is missing
+};
+
+std::vector<std::unique_ptr<TablePair>> tables;
+std::unordered_map<uint64_t, TablePair *> tablesByKey; // Both colourings
+int largestTable = 0;
+
+int treeLeft(const PairsData &d, int symbol) {
+  const unsigned char *node = d.tree + 3 * symbol;
+  return (node[1] & 0xF) << 8 | node[0];
+}
+
+int treeRight(const PairsData &d, int symbol) {
+  const unsigned char *node = d.tree + 3 * symbol;
+  return node[2] << 4 | node[1] >> 4;
+}
+
+uint8_t setSymLen(PairsData &d, int symbol, std::vector<bool> &visited) {
+  visited[symbol] = true;
+  const int right = treeRight(d, symbol);
+  if (right == 0xFFF)
+    return 0; // A value
+  const int left = treeLeft(d, symbol);
+  const int count = static_cast<int>(d.symLen.size());
+  if (left >= count || right >= count)
+    return 0;
+  if (!visited[left])
+    d.symLen[left] = setSymLen(d, left, visited);
+  if (!visited[right])
+    d.symLen[right] = setSymLen(d, right, visited);
+  return static_cast<uint8_t>(d.symLen[left] + d.symLen[right] + 1);
+}
+
+// Groups of pieces encoded together, from the piece order of the table,
+// and the weight of each group in the index; `order` says where the
+// leading group and the other side's pawns come in that product.
+void setGroups(const Table &table, PairsData &d, const int order[2],
+               int file) {
+  int groups = 0;
+  int firstLen = table.hasPawns ? 0 : table.hasUniquePieces ? 3 : 2;
+  d.groupLen[0] = 1;
+  for (int i = 1; i < table.pieceCount; ++i)
+    if (--firstLen > 0 || d.pieces[i] == d.pieces[i - 1])
+      ++d.groupLen[groups];
+    else
+      d.groupLen[++groups] = 1;
+  d.groupLen[++groups] = 0;
+
+  const bool bothPawns = table.hasPawns && table.pawnCount[1];
+  int next = bothPawns ? 2 : 1;
+  int freeSquares = 64 - d.groupLen[0] - (bothPawns ? d.groupLen[1] : 0);
+  uint64_t index = 1;
+  for (int k = 0; next < groups || k == order[0] || k == order[1]; ++k) {
+    if (k == order[0]) {
+      d.groupIdx[0] = index;
+      index *= table.hasPawns ? ENCODING.leadPawnsSize[d.groupLen[0]][file]
+               : table.hasUniquePieces ? 31332
+                                       : 462;
+    } else if (k == order[1]) {
+      d.groupIdx[1] = index;
+      index *= ENCODING.binomial[d.groupLen[1]][48 - d.groupLen[0]];
+    } else {
+      d.groupIdx[next] = index;
+      index *= ENCODING.binomial[d.groupLen[next]][freeSquares];
+      freeSquares -= d.groupLen[next++];
+    }
+  }
+  d.groupIdx[groups] = index; // Size of the sub-table
+}
+
+// The Huffman code of a sub-table; null when it runs past the file.
+const unsigned char *setSizes(PairsData &d, const unsigned char *data,
+                              const unsigned char *end) {
+  if (end - data < 2)
+    return nullptr;
+  d.flags = *data++;
+  if (d.flags & FLAG_SINGLE_VALUE) {
+    d.minSymLen = *data++;
+    return data;
+  }
+
+  const int groups = static_cast<int>(
+      std::find(d.groupLen, d.groupLen + TB_PIECES, 0) - d.groupLen);
+  const uint64_t size = d.groupIdx[groups];
+  if (end - data < 9 || data[0] > 31 || data[1] > 63)
+    return nullptr;
+  d.blockSize = uint64_t(1) << data[0];
+  d.span = uint64_t(1) << data[1];
+  d.sparseIndexSize = (size + d.span - 1) / d.span;
+  const int padding = data[2];
+  d.blockCount = static_cast<uint32_t>(readLittleEndian(data + 3, 4));
+  d.blockLengthSize = d.blockCount + padding;
+  const int maxSymLen = data[7];
+  d.minSymLen = data[8];
+  data += 9;
+  if (d.minSymLen < 1 || maxSymLen < d.minSymLen || maxSymLen > 32 ||
+      end - data < 2 * (maxSymLen - d.minSymLen + 1) + 2)
+    return nullptr;
+
+  // Canonical codes: longer codes have lower values, and every code of a
+  // length follows from the lowest one. base64[i] is the lowest code of
+  // length minSymLen + i, left-aligned in 64 bits.
+  d.lowestSym = data;
+  d.base64.assign(maxSymLen - d.minSymLen + 1, 0);
+  for (int i = static_cast<int>(d.base64.size()) - 2; i >= 0; --i)
+    d.base64[i] = (d.base64[i + 1] + readLittleEndian(d.lowestSym + 2 * i, 2) -
+                   readLittleEndian(d.lowestSym + 2 * (i + 1), 2)) /
+                  2;
+  for (size_t i = 0; i < d.base64.size(); ++i)
+    d.base64[i] <<= 64 - i - d.minSymLen;
+  data += 2 * d.base64.size();
+
+  d.symLen.assign(readLittleEndian(data, 2), 0);
+  d.tree = data + 2;
+  data = d.tree + 3 * d.symLen.size() + (d.symLen.size() & 1);
+  if (data > end)
+    return nullptr;
+  std::vector<bool> visited(d.symLen.size());
+  for (int symbol = 0; symbol < static_cast<int>(d.symLen.size()); ++symbol)
+    if (!visited[symbol])
+      d.symLen[symbol] = setSymLen(d, symbol, visited);
+  return data;
+}
+
+// Parses the headers of a mapped table and points its sub-tables into it.
+bool setup(Table &table) {
+  const unsigned char *begin = table.file.data();
+  const unsigned char *end = begin + table.file.size();
+  const unsigned char *magic = table.dtz ? DTZ_MAGIC : WDL_MAGIC;
+  if (table.file.size() < 6 || !std::equal(magic, magic + 4, begin))
+    return false;
+  auto align = [begin](const unsigned char *data, size_t to) {
+    return begin + (static_cast<size_t>(data - begin) + to - 1) / to * to;
+  };
+
+  const unsigned char *data = begin + 4;
+  const int header = *data++;
+  if (((header & HEADER_HAS_PAWNS) != 0) != table.hasPawns ||
+      ((header & HEADER_SPLIT) != 0) != (table.key != table.key2))
+    return false;
+
+  const int sides = !table.dtz && table.key != table.key2 ? 2 : 1;
+  const int files = table.hasPawns ? 4 : 1;
+  const bool bothPawns = table.hasPawns && table.pawnCount[1];
+  if (end - data < files * (1 + bothPawns + table.pieceCount))
+    return false;
+  for (int file = 0; file < files; ++file) {
+    const int order[2][2] = {
+        {data[0] & 0xF, bothPawns ? data[1] & 0xF : 0xF},
+        {data[0] >> 4, bothPawns ? data[1] >> 4 : 0xF}};
+    data += 1 + bothPawns;
+    for (int k = 0; k < table.pieceCount; ++k, ++data)
+      for (int side = 0; side < sides; ++side)
+        table.get(side, file).pieces[k] = side ? *data >> 4 : *data & 0xF;
+    for (int side = 0; side < sides; ++side)
+      setGroups(table, table.get(side, file), order[side], file);
+  }
+  data = align(data, 2);
+
+  for (int file = 0; file < files; ++file)
+    for (int side = 0; side < sides; ++side)
+      if (!(data = setSizes(table.get(side, file), data, end)))
+        return false;
+
+  if (table.dtz) {
+    table.map = data;
+    for (int file = 0; file < files; ++file) {
+      PairsData &d = table.get(0, file);
+      if (!(d.flags & FLAG_MAPPED))
+        continue;
+      // Four maps, each a count followed by that many values.
+      if (d.flags & FLAG_WIDE) {
+        data = align(data, 2);
+        for (int &index : d.mapIdx) {
+          index = static_cast<int>((data - table.map) / 2 + 1);
+          data += 2 * readLittleEndian(data, 2) + 2;
+        }
+      } else {
+        for (int &index : d.mapIdx) {
+          index = static_cast<int>(data - table.map + 1);
+          data += *data + 1;
+        }
+      }
+      if (data > end)
+        return false;
+    }
+    data = align(data, 2);
+  }
+
+  for (int file = 0; file < files; ++file)
+    for (int side = 0; side < sides; ++side) {
+      PairsData &d = table.get(side, file);
+      d.sparseIndex = data;
+      data += 6 * d.sparseIndexSize;
+    }
+  for (int file = 0; file < files; ++file)
+    for (int side = 0; side < sides; ++side) {
+      PairsData &d = table.get(side, file);
+      d.blockLength = data;
+      data += 2 * uint64_t(d.blockLengthSize);
+    }
+  for (int file = 0; file < files; ++file)
+    for (int side = 0; side < sides; ++side) {
+      PairsData &d = table.get(side, file);
+      if (d.blockCount)
+        data = align(data, 64);
+      d.data = data;
+      data += d.blockCount * d.blockSize;
+    }
+  return data <= end;
+}
+
+// The value at `index`. The sparse index gives the block and offset of
+// every span-th value; from there the block lengths lead to the right
+// block, whose symbols are read until one covers the offset, and that
+// symbol's pairs are then split down to a single value.
+int decompress(const PairsData &d, uint64_t index) {
+  if (d.flags & FLAG_SINGLE_VALUE)
+    return d.minSymLen;
+
+  const unsigned char *entry = d.sparseIndex + 6 * (index / d.span);
+  uint32_t block = static_cast<uint32_t>(readLittleEndian(entry, 4));
+  int offset = static_cast<int>(readLittleEndian(entry + 4, 2)) +
+               static_cast<int>(static_cast<int64_t>(index % d.span) -
+                                static_cast<int64_t>(d.span / 2));
+  auto blockLength = [&d](uint32_t block) {
+    return static_cast<int>(readLittleEndian(d.blockLength + 2 * block, 2));
+  };
+  while (offset < 0)
+    offset += blockLength(--block) + 1;
+  while (offset > blockLength(block))
+    offset -= blockLength(block++) + 1;
+
+  const unsigned char *next = d.data + block * d.blockSize;
+  uint64_t buffer = readBigEndian(next, 8);
+  next += 8;
+  int bits = 64; // Valid bits in the buffer
+  int symbol;
+  while (true) {
+    size_t length = 0; // Above minSymLen
+    while (buffer < d.base64[length])
+      ++length;
+    symbol = static_cast<int>((buffer - d.base64[length]) >>
+                              (64 - length - d.minSymLen)) +
+             static_cast<int>(readLittleEndian(d.lowestSym + 2 * length, 2));
+    if (offset < d.symLen[symbol] + 1)
+      break;
+    offset -= d.symLen[symbol] + 1;
+    length += d.minSymLen;
+    buffer <<= length;
+    bits -= static_cast<int>(length);
+    if (bits <= 32) {
+      bits += 32;
+      buffer |= readBigEndian(next, 4) << (64 - bits);
+      next += 4;
+    }
+  }
+
+  while (d.symLen[symbol]) {
+    const int left = treeLeft(d, symbol);
+    if (offset < d.symLen[left] + 1) {
+      symbol = left;
+    } else {
+      offset -= d.symLen[left] + 1;
+      symbol = treeRight(d, symbol);
+    }
+  }
+  return treeLeft(d, symbol);
+}
+
+// DTZ tables store moves, or plies near the fifty-move limit, and sort
+// the values of each result by frequency through a value map.
+int mapDtz(Table &table, int file, int value, int wdl) {
+  constexpr int MAP_OF_WDL[] = {1, 3, 0, 2, 0}; // Indexed by wdl + 2
+  const PairsData &d = table.get(0, file);
+  if (d.flags & FLAG_MAPPED) {
+    const int at = d.mapIdx[MAP_OF_WDL[wdl + 2]] + value;
+    value = d.flags & FLAG_WIDE
+                ? static_cast<int>(readLittleEndian(table.map + 2 * at, 2))
+                : table.map[at];
+  }
+  if ((wdl == WDL_WIN && !(d.flags & FLAG_WIN_PLIES)) ||
+      (wdl == WDL_LOSS && !(d.flags & FLAG_LOSS_PLIES)) ||
+      wdl == WDL_CURSED_WIN || wdl == WDL_BLESSED_LOSS)
+    value *= 2;
+  return value + 1;
+}
+
+// Piece codes of the tables: the PieceType, plus 8 for Black.
+int pieceCode(const Piece &piece) {
+  return static_cast<int>(piece.getType()) |
+         (piece.getColor() == Color::BLACK ? 8 : 0);
+}
+
+enum class Probe {
+  FAIL,
+  OK,
+  CHANGE_SIDE,       // The DTZ table holds the other side to move
+  ZEROING_BEST_MOVE, // A capture or pawn move is best; DTZ is not stored
+};
+
+// Sub-table and index of the position; false when a DTZ table holds the
+// other side to move. Tables are built with the first side of the name as
+// White; positions with colours the other way round are looked up with the
+// colours swapped and the board mirrored top to bottom, and likewise
+// symmetric ones with Black to move.
+bool encodePosition(const Board &board, Table &table, int &stm, int &tbFile,
+                    uint64_t &index) {
+  int squares[TB_PIECES];
+  int pieces[TB_PIECES];
+  int size = 0, leadPawnCount = 0;
+  tbFile = 0;
+  Bitboard leadPawns = 0;
+  const bool blackToMove = board.getSideToMove() == Color::BLACK;
+  const bool flip = (table.key == table.key2 && blackToMove) ||
+                    board.getMaterialKey() != table.key;
+  const int flipColor = flip ? 8 : 0;
+  const int flipSquares = flip ? 56 : 0;
+  stm = flip != blackToMove;
+  auto pawnOrder = [](int a, int b) {
+    return ENCODING.mapPawns[a] < ENCODING.mapPawns[b];
+  };
+
+  // Tables with pawns are split by the file of the leading pawn.
+  if (table.hasPawns) {
+    const int leadCode = table.get(0, 0).pieces[0] ^ flipColor;
+    leadPawns = board.getPieces(leadCode & 8 ? Color::BLACK : Color::WHITE,
+                                PieceType::PAWN);
+    for (Bitboard pawns = leadPawns; pawns;)
+      squares[size++] = popLsb(pawns) ^ flipSquares;
+    leadPawnCount = size;
+    std::swap(squares[0],
+              *std::max_element(squares, squares + size, pawnOrder));
+    tbFile = std::min(fileOf(squares[0]), 7 - fileOf(squares[0]));
+  }
+
+  if (table.dtz &&
+      (table.get(0, tbFile).flags & FLAG_BLACK_TO_MOVE) != stm &&
+      (table.key != table.key2 || table.hasPawns))
+    return false;
+
+  Bitboard rest =
+      (board.getOccupied(Color::WHITE) | board.getOccupied(Color::BLACK)) &
+      ~leadPawns;
+  while (rest) {
+    const int square = popLsb(rest);
+    squares[size] = square ^ flipSquares;
+    pieces[size++] = pieceCode(board.getPiece(
+                         square / BOARD_SIZE, square % BOARD_SIZE)) ^
+                     flipColor;
+  }
+
+  // Put the pieces in the order the table encodes them.
+  const PairsData &d = table.get(stm, tbFile);
+  for (int i = leadPawnCount; i < size - 1; ++i)
+    for (int j = i; j < size; ++j)
+      if (d.pieces[i] == pieces[j]) {
+        std::swap(pieces[i], pieces[j]);
+        std::swap(squares[i], squares[j]);
+        break;
+      }
+
+  if (fileOf(squares[0]) > 3)
+    for (int i = 0; i < size; ++i)
+      squares[i] = flipFile(squares[i]);
+
+  if (table.hasPawns) {
+    index = ENCODING.leadPawnIdx[leadPawnCount][squares[0]];
+    std::stable_sort(squares + 1, squares + leadPawnCount, pawnOrder);
+    for (int i = 1; i < leadPawnCount; ++i)
+      index += ENCODING.binomial[i][ENCODING.mapPawns[squares[i]]];
+  } else {
+    // Bring the leading piece into the a1-d1-d4 triangle, and the first
+    // piece of the leading group off the diagonal below it.
+    if (rankOf(squares[0]) > 3)
+      for (int i = 0; i < size; ++i)
+        squares[i] = flipRank(squares[i]);
+    for (int i = 0; i < d.groupLen[0]; ++i) {
+      if (!offDiagonal(squares[i]))
+        continue;
+      if (offDiagonal(squares[i]) > 0)
+        for (int j = i; j < size; ++j)
+          squares[j] = transpose(squares[j]);
+      break;
+    }
+
+    if (table.hasUniquePieces) {
+      // Three unique pieces, by how many of them are on the diagonal.
+      const int s0 = squares[0], s1 = squares[1], s2 = squares[2];
+      const int adjust1 = s1 > s0;
+      const int adjust2 = (s2 > s0) + (s2 > s1);
+      if (offDiagonal(s0))
+        index = (ENCODING.mapA1D1D4[s0] * 63 + (s1 - adjust1)) * 62 + s2 -
+                adjust2;
+      else if (offDiagonal(s1))
+        index = (6 * 63 + rankOf(s0) * 28 + ENCODING.mapB1H1H7[s1]) * 62 +
+                s2 - adjust2;
+      else if (offDiagonal(s2))
+        index = 6 * 63 * 62 + 4 * 28 * 62 + rankOf(s0) * 7 * 28 +
+                (rankOf(s1) - adjust1) * 28 + ENCODING.mapB1H1H7[s2];
+      else
+        index = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 + rankOf(s0) * 7 * 6 +
+                (rankOf(s1) - adjust1) * 6 + (rankOf(s2) - adjust2);
+    } else {
+      index = ENCODING.mapKK[ENCODING.mapA1D1D4[squares[0]]][squares[1]];
+    }
+  }
+
+  // The remaining groups, each on the squares the earlier ones left free.
+  index *= d.groupIdx[0];
+  int *group = squares + d.groupLen[0];
+  bool remainingPawns = table.hasPawns && table.pawnCount[1];
+  for (int next = 1; d.groupLen[next]; ++next) {
+    std::sort(group, group + d.groupLen[next]);
+    uint64_t n = 0;
+    for (int i = 0; i < d.groupLen[next]; ++i) {
+      const int below = static_cast<int>(std::count_if(
+          squares, group, [&](int square) { return group[i] > square; }));
+      n += ENCODING.binomial[i + 1][group[i] - below -
+                                    (remainingPawns ? BOARD_SIZE : 0)];
+    }
+    remainingPawns = false;
+    index += n * d.groupIdx[next];
+    group += d.groupLen[next];
+  }
+
+  return true;
+}
+
+// Value stored for the position: WDL, or DTZ given the position's WDL.
+int readTable(const Board &board, Table &table, int wdl, Probe &state) {
+  int stm, file;
+  uint64_t index;
+  if (!encodePosition(board, table, stm, file, index)) {
+    state = Probe::CHANGE_SIDE;
+    return 0;
+  }
+  const int value = decompress(table.get(stm, file), index);
+  return table.dtz ? mapDtz(table, file, value, wdl) : value - 2;
+}
+
+int probeTable(const Board &board, bool dtz, int wdl, Probe &state) {
+  if (popCount(board.getOccupied(Color::WHITE) |
+               board.getOccupied(Color::BLACK)) == 2)
+    return 0; // Bare kings
+  const auto found = tablesByKey.find(board.getMaterialKey());
+  if (found == tablesByKey.end()) {
+    state = Probe::FAIL;
+    return 0;
+  }
+  Table &table = dtz ? found->second->dtz : found->second->wdl;
+  if (!table.file.isOpen()) {
+    state = Probe::FAIL;
+    return 0;
+  }
+  return readTable(board, table, wdl, state);
+}
+
+bool isCapture(const Board &board, const Move &move) {
+  return !board.getPiece(move.endRow, move.endCol).isEmpty() ||
+         (board.getPiece(move.startRow, move.startCol).getType() ==
+              PieceType::PAWN &&
+          move.startCol != move.endCol);
+}
+
+bool isZeroing(const Board &board, const Move &move) {
+  return isCapture(board, move) ||
+         board.getPiece(move.startRow, move.startCol).getType() ==
+             PieceType::PAWN;
+}
+
+void generateLegalMoves(Board &board, MoveList &legal) {
+  MoveList moves;
+  MoveGenerator().generateMoves(board, board.getSideToMove(), moves);
+  for (const Move &move : moves) {
+    board.makeMove(move);
+    if (!board.isInCheck(opposite(board.getSideToMove())))
+      legal.push_back(move);
+    board.unmakeMove(move);
+  }
+}
+
+bool isMate(Board &board) {
+  MoveList moves;
+  generateLegalMoves(board, moves);
+  return moves.empty() && board.isInCheck(board.getSideToMove());
+}
+
+// The tables may store any value for a position that a capture wins, the
+// best value that leaves the result unchanged for compression, and they
+// ignore en passant. So captures (and for DTZ pawn moves) are searched and
+// the best of their results and the stored one is the position's.
+int search(Board &board, Probe &state, bool pawnMovesToo) {
+  MoveList moves;
+  generateLegalMoves(board, moves);
+  int best = WDL_LOSS;
+  int tried = 0;
+  for (const Move &move : moves) {
+    if (!(pawnMovesToo ? isZeroing(board, move) : isCapture(board, move)))
+      continue;
+    ++tried;
+    board.makeMove(move);
+    const int value = -search(board, state, false);
+    board.unmakeMove(move);
+    if (state == Probe::FAIL)
+      return WDL_DRAW;
+    if (value > best) {
+      best = value;
+      if (value >= WDL_WIN) {
+        state = Probe::ZEROING_BEST_MOVE;
+        return value;
+      }
+    }
+  }
+
+  // Every legal move tried: the stored value may be wrong.
+  const bool allTried = tried && tried == moves.size();
+  int value = best;
+  if (!allTried) {
+    value = probeTable(board, false, WDL_DRAW, state);
+    if (state == Probe::FAIL)
+      return WDL_DRAW;
+  }
+  if (best >= value) {
+    state = best > WDL_DRAW || allTried ? Probe::ZEROING_BEST_MOVE
+                                        : Probe::OK;
+    return best;
+  }
+  state = Probe::OK;
+  return value;
+}
+
+// DTZ just before a zeroing move that reaches the result.
+int dtzBeforeZeroing(int wdl) {
+  switch (wdl) {
+  case WDL_WIN:
+    return 1;
+  case WDL_CURSED_WIN:
+    return 101;
+  case WDL_BLESSED_LOSS:
+    return -101;
+  case WDL_LOSS:
+    return -1;
+  default:
+    return 0;
+  }
+}
+
+int probeDtzTable(Board &board, Probe &state) {
+  state = Probe::OK;
+  const int wdl = search(board, state, true);
+  if (state == Probe::FAIL || wdl == WDL_DRAW)
+    return 0;
+  if (state == Probe::ZEROING_BEST_MOVE)
+    return dtzBeforeZeroing(wdl);
+
+  int dtz = probeTable(board, true, wdl, state);
+  if (state == Probe::FAIL)
+    return 0;
+  if (state != Probe::CHANGE_SIDE)
+    return (dtz + 100 * (wdl == WDL_BLESSED_LOSS || wdl == WDL_CURSED_WIN)) *
+           sign(wdl);
+
+  // Stored for the other side: the best reply one ply down.
+  MoveList moves;
+  generateLegalMoves(board, moves);
+  int best = 0xFFFF;
+  for (const Move &move : moves) {
+    const bool zeroing = isZeroing(board, move);
+    board.makeMove(move);
+    dtz = zeroing ? -dtzBeforeZeroing(search(board, state, false))
+                  : -probeDtzTable(board, state);
+    if (dtz == 1 && isMate(board))
+      best = 1;
+    if (!zeroing)
+      dtz += sign(dtz);
+    if (dtz < best && sign(dtz) == sign(wdl))
+      best = dtz;
+    board.unmakeMove(move);
+    if (state == Probe::FAIL)
+      return 0;
+  }
+  return best == 0xFFFF ? -1 : best;
+}
+
+bool canProbe(const Board &board) {
+  return largestTable && !board.getCastlingRights() &&
+         popCount(board.getOccupied(Color::WHITE) |
+                  board.getOccupied(Color::BLACK)) <= largestTable;
+}
+
+// Whether any position since the last zeroing move occurred twice.
+bool hasRepeated(const Board &board) {
+  const int size = board.getHistorySize();
+  const int earliest = std::max(0, size - board.getHalfmoveClock());
+  for (int i = size; i >= earliest + 4; --i)
+    for (int j = i - 4; j >= earliest; j -= 2)
+      if (board.getHistoryHash(j) == board.getHistoryHash(i))
+        return true;
+  return false;
+}
+
+uint64_t materialKey(const std::string &white, const std::string &black) {
+  uint64_t key = 0;
+  int counts[2][7] = {};
+  for (Color color : {Color::WHITE, Color::BLACK})
+    for (char letter : color == Color::WHITE ? white : black) {
+      const int type =
+          static_cast<int>(std::string_view(PIECE_LETTERS).find(letter));
+      key ^= zobrist::materialKey(color, static_cast<PieceType>(type),
+                                  counts[static_cast<int>(color)][type]++);
+    }
+  return key;
+}
+
+std::string findFile(const std::vector<std::string> &directories,
+                     const std::string &name) {
+  for (const std::string &directory : directories) {
+    std::error_code error;
+    const std::filesystem::path path =
+        std::filesystem::path(directory) / name;
+    if (std::filesystem::is_regular_file(path, error))
+      return path.string();
+  }
+  return "";
+}
+
+// Maps both files of one material, named by its pieces like "KRPvKR".
+void addTable(const std::vector<std::string> &directories,
+              const std::string &white, const std::string &black) {
+  const std::string name = white + "v" + black;
+  const std::string wdlPath = findFile(directories, name + ".rtbw");
+  if (wdlPath.empty())
+    return;
+
+  auto pair = std::make_unique<TablePair>();
+  for (Table *table : {&pair->wdl, &pair->dtz}) {
+    table->dtz = table == &pair->dtz;
+    table->key = materialKey(white, black);
+    table->key2 = materialKey(black, white);
+    table->pieceCount = static_cast<int>(white.size() + black.size());
+    const int whitePawns =
+        static_cast<int>(std::count(white.begin(), white.end(), 'P'));
+    const int blackPawns =
+        static_cast<int>(std::count(black.begin(), black.end(), 'P'));
+    table->hasPawns = whitePawns + blackPawns > 0;
+    for (const std::string *side : {&white, &black})
+      for (char letter : std::string_view(NAME_ORDER))
+        if (std::count(side->begin(), side->end(), letter) == 1)
+          table->hasUniquePieces = true;
+    // Pawns lead from the side with fewer of them, for compression.
+    const bool whiteLeads =
+        !blackPawns || (whitePawns && blackPawns >= whitePawns);
+    table->pawnCount[0] = whiteLeads ? whitePawns : blackPawns;
+    table->pawnCount[1] = whiteLeads ? blackPawns : whitePawns;
+  }
+  if (tablesByKey.count(pair->wdl.key) ||
+      !pair->wdl.file.open(wdlPath, MappedFile::Access::RANDOM) ||
+      !setup(pair->wdl))
+    return;
+  const std::string dtzPath = findFile(directories, name + ".rtbz");
+  if (!dtzPath.empty() &&
+      (!pair->dtz.file.open(dtzPath, MappedFile::Access::RANDOM) ||
+       !setup(pair->dtz)))
+    pair->dtz.file.close();
+
+  largestTable = std::max(largestTable, pair->wdl.pieceCount);
+  tablesByKey[pair->wdl.key] = pair.get();
+  tablesByKey[pair->wdl.key2] = pair.get();
+  tables.push_back(std::move(pair));
+}
+
+// Every way to add `left` more pieces to `pieces`, in file name order.
+void collectPieces(std::string pieces, size_t first, int left,
+                   std::vector<std::string> &out) {
+  out.push_back(pieces);
+  if (left == 0)
+    return;
+  for (size_t i = first; i < std::char_traits<char>::length(NAME_ORDER); ++i)
+    collectPieces(pieces + NAME_ORDER[i], i, left - 1, out);
+}
+
+} // namespace
+
+int init(const std::string &paths) {
+  tables.clear();
+  tablesByKey.clear();
+  largestTable = 0;
+  if (paths.empty() || paths == "<empty>")
+    return 0;
+
+  std::vector<std::string> directories;
+  size_t start = 0;
+  while (start <= paths.size()) {
+    const size_t stop = std::min(paths.find(PATH_SEPARATOR, start),
+                                 paths.size());
+    if (stop > start)
+      directories.push_back(paths.substr(start, stop - start));
+    start = stop + 1;
+  }
+
+  std::vector<std::string> sides;
+  collectPieces("K", 0, TB_PIECES - 2, sides);
+  for (const std::string &white : sides)
+    for (const std::string &black : sides)
+      if (white.size() + black.size() <= TB_PIECES &&
+          white.size() + black.size() > 2)
+        addTable(directories, white, black);
+  return static_cast<int>(tables.size());
+}
+
+int largest() { return largestTable; }
+
+bool probeWdl(Board &board, int &wdl) {
+  if (!canProbe(board))
+    return false;
+  Probe state = Probe::OK;
+  wdl = search(board, state, false);
+  return state != Probe::FAIL;
+}
+
+bool probeDtz(Board &board, int &dtz) {
+  if (!canProbe(board))
+    return false;
+  Probe state = Probe::OK;
+  dtz = probeDtzTable(board, state);
+  return state != Probe::FAIL;
+}
+
+bool rankRootMoves(Board &board, std::vector<RootMove> &moves) {
+  if (!canProbe(board))
+    return false;
+  const int clock = board.getHalfmoveClock();
+  const bool repeated = hasRepeated(board);
+  for (RootMove &root : moves) {
+    Probe state = Probe::OK;
+    board.makeMove(root.move);
+    int dtz;
+    if (board.getHalfmoveClock() == 0) {
+      dtz = dtzBeforeZeroing(-search(board, state, false));
+    } else if (board.isDraw()) {
+      dtz = 0;
+    } else {
+      dtz = -probeDtzTable(board, state);
+      dtz += sign(dtz); // Counted from the root
+    }
+    if (dtz == 2 && isMate(board))
+      dtz = 1;
+    board.unmakeMove(root.move);
+    if (state == Probe::FAIL)
+      return false;
+
+    // Wins that fit in the moves the rule leaves rank alike, unless the
+    // game has started repeating; so do losses the rule cannot save.
+    if (dtz > 0)
+      root.rank = dtz + clock <= 99 && !repeated ? MAX_RANK
+                                                 : MAX_RANK - (dtz + clock);
+    else if (dtz < 0)
+      root.rank = -dtz * 2 + clock < 100 ? -MAX_RANK
+                                         : -MAX_RANK + (-dtz + clock);
+    else
+      root.rank = 0;
+  }
+  return true;
+}
+
+bool rankRootMovesByWdl(Board &board, std::vector<RootMove> &moves) {
+  constexpr int RANK_OF_WDL[] = {-MAX_RANK, -MAX_RANK + 101, 0,
+                                 MAX_RANK - 101, MAX_RANK};
+  if (!canProbe(board))
+    return false;
+  for (RootMove &root : moves) {
+    Probe state = Probe::OK;
+    board.makeMove(root.move);
+    const int wdl = -search(board, state, false);
+    board.unmakeMove(root.move);
+    if (state == Probe::FAIL)
+      return false;
+    root.rank = RANK_OF_WDL[wdl + 2];
+  }
+  return true;
+}
+
+} // namespace syzygy
+} // namespace chess
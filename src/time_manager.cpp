@@ -0,0 +1,76 @@
+#include "time_manager.hpp"
+#include "search.hpp"
+#include <algorithm>
+
+namespace chess {
+
+namespace {
+
+constexpr int DEFAULT_MOVES_TO_GO = 30;
+constexpr int MAX_MOVES_TO_GO = 50;
+
+} // namespace
+
+void TimeManager::start(const SearchLimits &limits, Color us) {
+  startTime_ = std::chrono::steady_clock::now();
+  int64_t time = us == Color::WHITE ? limits.whiteTime : limits.blackTime;
+  int64_t increment =
+      us == Color::WHITE ? limits.whiteIncrement : limits.blackIncrement;
+  active_ = !limits.infinite && (limits.moveTime > 0 || time > 0);
+  if (!active_)
+    return;
+
+  if (limits.moveTime > 0) {
+    softLimit_ = hardLimit_ =
+        std::max<int64_t>(limits.moveTime - limits.moveOverhead, 1);
+    return;
+  }
+
+  int64_t available = std::max<int64_t>(time - limits.moveOverhead, 1);
+  int movesToGo = limits.movesToGo > 0
+                      ? std::min(limits.movesToGo, MAX_MOVES_TO_GO)
+                      : DEFAULT_MOVES_TO_GO;
+  // Never plan to spend more than 80% of the clock on one move.
+  hardLimit_ = std::min(available * 4 / 5,
+                        4 * (available / movesToGo + increment * 3 / 4));
+  softLimit_ = std::min(available / movesToGo + increment * 3 / 4, hardLimit_);
+  hardLimit_ = std::max<int64_t>(hardLimit_, 1);
+  softLimit_ = std::max<int64_t>(softLimit_, 1);
+}
+
+bool TimeManager::isActive() const { return active_; }
+
+int64_t TimeManager::elapsed() const {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now() - startTime_)
+      .count();
+}
+
+int64_t TimeManager::getSoftLimit() const { return softLimit_; }
+
+int64_t TimeManager::getHardLimit() const { return hardLimit_; }
+
+bool TimeManager::hardLimitReached() const {
+  return active_ && elapsed() >= hardLimit_;
+}
+
+bool TimeManager::shouldStopIteration(int bestMoveStability, int scoreDrop,
+                                      double bestMoveNodeShare) const {
+  if (!active_)
+    return false;
+  if (softLimit_ == hardLimit_) // Fixed movetime: use all of it
+    return elapsed() >= hardLimit_;
+
+  // A best move that keeps winning the iterations needs less confirmation.
+  double stability = 1.3 - 0.1 * std::min(bestMoveStability, 8);
+  // A falling score means trouble: think longer.
+  double score = std::clamp(1.0 + scoreDrop / 100.0, 0.8, 1.6);
+  // If most of the effort went into refuting alternatives, the best move is
+  // contested.
+  double effort = (1.5 - std::clamp(bestMoveNodeShare, 0.0, 1.0)) * 1.2;
+
+  double scaled = softLimit_ * stability * score * effort;
+  return elapsed() >= std::min<double>(scaled, hardLimit_);
+}
+
+} // namespace chess
@@ -0,0 +1,232 @@
+#include "transposition_table.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace chess {
+
+namespace {
+
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+// Payload layout: move | score << 16 | eval << 32 | depth << 48 |
+// bound << 56 | generation << 58.
+uint64_t packData(uint16_t move, int score, int eval, int depth, Bound bound,
+                  uint8_t generation) {
+  return static_cast<uint64_t>(move) |
+         static_cast<uint64_t>(static_cast<uint16_t>(score)) << 16 |
+         static_cast<uint64_t>(static_cast<uint16_t>(eval)) << 32 |
+         static_cast<uint64_t>(static_cast<uint8_t>(depth)) << 48 |
+         static_cast<uint64_t>(bound) << 56 |
+         static_cast<uint64_t>(generation & 0x3F) << 58;
+}
+
+int dataDepth(uint64_t data) { return static_cast<int8_t>(data >> 48); }
+Bound dataBound(uint64_t data) { return static_cast<Bound>((data >> 56) & 3); }
+uint8_t dataGeneration(uint64_t data) { return (data >> 58) & 0x3F; }
+
+bool transparentHugePagesDisabled() {
+  std::ifstream file("/sys/kernel/mm/transparent_hugepage/enabled");
+  std::string setting;
+  std::getline(file, setting);
+  return !file || setting.find("[never]") != std::string::npos;
+}
+
+} // namespace
+
+TranspositionTable::TranspositionTable(size_t megabytes, int threads) {
+  resize(megabytes, threads);
+}
+
+TranspositionTable::~TranspositionTable() { release(); }
+
+void TranspositionTable::resize(size_t megabytes, int threads) {
+  release();
+  allocate(std::max<size_t>(megabytes, 1) * 1024 * 1024);
+  clear(threads);
+}
+
+void TranspositionTable::allocate(size_t bytes) {
+  clusterCount_ = bytes / sizeof(Cluster);
+  size_t rounded = (clusterCount_ * sizeof(Cluster) + HUGE_PAGE_SIZE - 1) /
+                   HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+
+#if defined(__linux__)
+  // Explicit huge pages only succeed if the admin reserved a hugetlb pool.
+  void *memory = mmap(nullptr, rounded, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (memory != MAP_FAILED) {
+    table_ = static_cast<Cluster *>(memory);
+    allocatedBytes_ = rounded;
+    backing_ = Backing::HUGETLB;
+    return;
+  }
+#endif
+
+  // Otherwise align to 2 MB so the kernel can back the range with THP.
+  void *aligned = std::aligned_alloc(HUGE_PAGE_SIZE, rounded);
+  if (!aligned)
+    throw std::bad_alloc();
+  table_ = static_cast<Cluster *>(aligned);
+  allocatedBytes_ = rounded;
+  backing_ = Backing::SMALL_PAGES;
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (madvise(aligned, rounded, MADV_HUGEPAGE) == 0 &&
+      !transparentHugePagesDisabled())
+    backing_ = Backing::TRANSPARENT_HUGE_PAGES;
+#endif
+}
+
+void TranspositionTable::release() {
+  if (!table_)
+    return;
+#if defined(__linux__)
+  if (backing_ == Backing::HUGETLB)
+    munmap(table_, allocatedBytes_);
+  else
+    std::free(table_);
+#else
+  std::free(table_);
+#endif
+  table_ = nullptr;
+  clusterCount_ = 0;
+  allocatedBytes_ = 0;
+  backing_ = Backing::NONE;
+}
+
+void TranspositionTable::clear(int threads) {
+  // Each thread zeroes (and thereby faults in) its own slice of the table.
+  char *base = reinterpret_cast<char *>(table_);
+  size_t bytes = clusterCount_ * sizeof(Cluster);
+  size_t count = std::max(threads, 1);
+  size_t stride = (bytes / count + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE *
+                  HUGE_PAGE_SIZE;
+
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < count && i * stride < bytes; ++i)
+    workers.emplace_back([=] {
+      std::memset(base + i * stride, 0, std::min(stride, bytes - i * stride));
+    });
+  std::memset(base, 0, std::min(stride, bytes));
+  for (auto &worker : workers)
+    worker.join();
+  generation_ = 0;
+}
+
+void TranspositionTable::newSearch() { generation_ = (generation_ + 1) & 0x3F; }
+
+TranspositionTable::Cluster *TranspositionTable::clusterFor(uint64_t key) const {
+#if defined(__SIZEOF_INT128__)
+  return &table_[static_cast<uint64_t>(
+      (static_cast<unsigned __int128>(key) * clusterCount_) >> 64)];
+#else
+  return &table_[key % clusterCount_];
+#endif
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry &entry) const {
+  Cluster *cluster = clusterFor(key);
+  for (Slot &slot : cluster->slots) {
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if ((check ^ data) != key || dataBound(data) == Bound::NONE)
+      continue;
+    entry.move = static_cast<uint16_t>(data);
+    entry.score = static_cast<int16_t>(data >> 16);
+    entry.eval = static_cast<int16_t>(data >> 32);
+    entry.depth = static_cast<int8_t>(dataDepth(data));
+    entry.bound = dataBound(data);
+    return true;
+  }
+  return false;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, int score, int eval,
+                               Bound bound, uint16_t move) {
+  Cluster *cluster = clusterFor(key);
+  Slot *replace = &cluster->slots[0];
+  int worst = 1 << 30;
+  for (Slot &slot : cluster->slots) {
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if ((check ^ data) == key) {
+      // Same position: keep the old move if the new search found none.
+      if (move == 0)
+        move = static_cast<uint16_t>(data);
+      replace = &slot;
+      break;
+    }
+    int age = (generation_ - dataGeneration(data)) & 0x3F;
+    int value = dataBound(data) == Bound::NONE ? -(1 << 20)
+                                               : dataDepth(data) - 8 * age;
+    if (value < worst) {
+      worst = value;
+      replace = &slot;
+    }
+  }
+  uint64_t data = packData(move, score, eval, std::clamp(depth, -128, 127),
+                           bound, generation_);
+  replace->data.store(data, std::memory_order_relaxed);
+  replace->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::prefetch(uint64_t key) const {
+#if defined(__GNUC__)
+  __builtin_prefetch(clusterFor(key));
+#else
+  (void)key;
+#endif
+}
+
+int TranspositionTable::hashfull() const {
+  size_t samples = std::min<size_t>(1000, clusterCount_);
+  int used = 0;
+  for (size_t i = 0; i < samples; ++i)
+    for (const Slot &slot : table_[i].slots) {
+      uint64_t data = slot.data.load(std::memory_order_relaxed);
+      if (dataBound(data) != Bound::NONE &&
+          dataGeneration(data) == generation_)
+        ++used;
+    }
+  return samples ? static_cast<int>(used * 1000 /
+                                    (samples * SLOTS_PER_CLUSTER))
+                 : 0;
+}
+
+TranspositionTable::Backing TranspositionTable::getBacking() const {
+  return backing_;
+}
+
+const char *TranspositionTable::backingName() const {
+  switch (backing_) {
+  case Backing::HUGETLB:
+    return "2 MB huge pages (MAP_HUGETLB)";
+  case Backing::TRANSPARENT_HUGE_PAGES:
+    return "transparent huge pages (madvise)";
+  case Backing::SMALL_PAGES:
+    return "4 KB pages";
+  case Backing::NONE:
+    break;
+  }
+  return "none";
+}
+
+size_t TranspositionTable::sizeInBytes() const {
+  return clusterCount_ * sizeof(Cluster);
+}
+
+std::string TranspositionTable::describe() const {
+  return "Hash " + std::to_string(sizeInBytes() / (1024 * 1024)) +
+         " MB backed by " + backingName();
+}
+
+} // namespace chess
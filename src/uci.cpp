@@ -0,0 +1,434 @@
+#include "uci.hpp"
+#include "epd.hpp"
+#include "nnue.hpp"
+#include "nnue_kernels.hpp"
+#include "notation.hpp"
+#include "syzygy.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <istream>
+#include <ostream>
+
+namespace chess {
+
+namespace {
+
+constexpr int DEFAULT_HASH_MB = 16;
+constexpr int MAX_HASH_MB = 65536;
+constexpr int MAX_MOVE_OVERHEAD = 5000;
+constexpr int MAX_SYZYGY_PIECES = 7;
+
+int hardwareThreads() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+std::string toLower(std::string text) {
+  std::transform(text.begin(), text.end(), text.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return text;
+}
+
+std::string scoreToUci(int score) {
+  if (score >= VALUE_MATE_IN_MAX_PLY)
+    return "mate " + std::to_string((VALUE_MATE - score + 1) / 2);
+  if (score <= -VALUE_MATE_IN_MAX_PLY)
+    return "mate " + std::to_string(-(VALUE_MATE + score) / 2);
+  return "cp " + std::to_string(score);
+}
+
+} // namespace
+
+Uci::Uci(std::istream &in, std::ostream &out)
+    : in_(in), out_(out), tt_(DEFAULT_HASH_MB, hardwareThreads()),
+      search_(tt_), hashMegabytes_(DEFAULT_HASH_MB),
+      random_(std::random_device{}()) {
+  search_.setInfoCallback(
+      [this](const SearchResult &result) { sendInfo(result); });
+}
+
+Uci::~Uci() { stopSearch(); }
+
+const TranspositionTable &Uci::getHashTable() const { return tt_; }
+
+void Uci::loop() {
+  std::string line;
+  while (std::getline(in_, line))
+    if (!execute(line))
+      return;
+  stopSearch();
+}
+
+bool Uci::execute(const std::string &line) {
+  std::istringstream args(line);
+  std::string command;
+  if (!(args >> command))
+    return true;
+
+  if (command == "uci") {
+    identify();
+  } else if (command == "isready") {
+    send("readyok");
+  } else if (command == "ucinewgame") {
+    stopSearch();
+    tt_.clear(hardwareThreads());
+    search_.clear();
+  } else if (command == "position") {
+    stopSearch();
+    position(args);
+  } else if (command == "go") {
+    stopSearch();
+    go(args);
+  } else if (command == "stop") {
+    stopSearch();
+  } else if (command == "ponderhit") {
+    ponderHit();
+  } else if (command == "setoption") {
+    stopSearch();
+    setOption(args);
+  } else if (command == "epd") {
+    stopSearch();
+    solveEpd(args);
+  } else if (command == "quit") {
+    stopSearch();
+    return false;
+  } else {
+    send("info string Unknown command: " + line);
+  }
+  return true;
+}
+
+void Uci::identify() {
+  send("id name ChessEngine");
+  send("id author the ChessEngine developers");
+  send("option name Hash type spin default " +
+       std::to_string(DEFAULT_HASH_MB) + " min 1 max " +
+       std::to_string(MAX_HASH_MB));
+  send("option name Clear Hash type button");
+  send("option name Ponder type check default false");
+  send("option name Move Overhead type spin default 30 min 0 max " +
+       std::to_string(MAX_MOVE_OVERHEAD));
+  send("option name EvalFile type string default <empty>");
+  send("option name OwnBook type check default false");
+  send("option name BookFile type string default <empty>");
+  send("option name Best Book Move type check default false");
+  send("option name SyzygyPath type string default <empty>");
+  send("option name SyzygyProbeDepth type spin default 1 min 1 max 100");
+  send("option name Syzygy50MoveRule type check default true");
+  send("option name SyzygyProbeLimit type spin default 7 min 0 max " +
+       std::to_string(MAX_SYZYGY_PIECES));
+  send("uciok");
+  send("info string " + tt_.describe());
+}
+
+void Uci::position(std::istringstream &args) {
+  std::string token;
+  args >> token;
+  Board board;
+  if (token == "fen") {
+    std::string fen;
+    while (args >> token && token != "moves")
+      fen += token + " ";
+    if (!board.fromFEN(fen)) {
+      send("info string Invalid FEN: " + fen);
+      return;
+    }
+  } else if (token == "startpos") {
+    args >> token; // "moves", if any
+  } else {
+    send("info string Expected startpos or fen");
+    return;
+  }
+
+  // The board keeps the moves so that the search sees repetitions.
+  while (args >> token) {
+    Move move = parseUciMove(board, token);
+    if (move == Move()) {
+      send("info string Illegal move: " + token);
+      break;
+    }
+    board.makeMove(move);
+  }
+  board_ = std::move(board);
+}
+
+void Uci::go(std::istringstream &args) {
+  SearchLimits limits;
+  limits.moveOverhead = moveOverhead_;
+  limits.syzygyProbeDepth = syzygyProbeDepth_;
+  limits.syzygyProbeLimit = syzygyProbeLimit_;
+  limits.syzygy50MoveRule = syzygy50MoveRule_;
+  std::string token;
+  while (args >> token) {
+    if (token == "wtime")
+      args >> limits.whiteTime;
+    else if (token == "btime")
+      args >> limits.blackTime;
+    else if (token == "winc")
+      args >> limits.whiteIncrement;
+    else if (token == "binc")
+      args >> limits.blackIncrement;
+    else if (token == "movestogo")
+      args >> limits.movesToGo;
+    else if (token == "depth")
+      args >> limits.depth;
+    else if (token == "nodes")
+      args >> limits.nodes;
+    else if (token == "movetime")
+      args >> limits.moveTime;
+    else if (token == "mate") {
+      // Mate in n moves lies within 2n - 1 plies.
+      int moves = 0;
+      args >> moves;
+      limits.depth = std::clamp(2 * moves - 1, 1, MAX_PLY - 1);
+    } else if (token == "infinite")
+      limits.infinite = true;
+    else if (token == "ponder")
+      limits.ponder = true;
+    else if (token == "searchmoves") {
+      // Moves run to the end of the line or the next keyword.
+      std::streampos start = args.tellg();
+      while (args >> token) {
+        Move move = parseUciMove(board_, token);
+        if (move == Move()) {
+          args.clear();
+          args.seekg(start);
+          break;
+        }
+        limits.searchMoves.push_back(move);
+        start = args.tellg();
+      }
+    }
+  }
+
+  // Book moves are played at once, except while the GUI waits for a
+  // ponderhit or stop.
+  if (ownBook_ && !limits.infinite && !limits.ponder &&
+      limits.searchMoves.empty()) {
+    Move move = book_.pickMove(board_, bestBookMove_, random_());
+    if (move != Move()) {
+      send("bestmove " + moveToUci(move));
+      return;
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(releaseMutex_);
+    stopRequested_ = false;
+    ponderHitReceived_ = false;
+  }
+  searching_.store(true);
+  searchThread_ = std::thread(&Uci::runSearch, this, std::move(limits));
+}
+
+void Uci::setOption(std::istringstream &args) {
+  std::string token, name, value;
+  args >> token; // "name"
+  while (args >> token && token != "value")
+    name += (name.empty() ? "" : " ") + token;
+  while (args >> token)
+    value += (value.empty() ? "" : " ") + token;
+  name = toLower(name);
+
+  if (name == "hash") {
+    hashMegabytes_ = std::clamp(std::atoi(value.c_str()), 1, MAX_HASH_MB);
+    tt_.resize(static_cast<size_t>(hashMegabytes_), hardwareThreads());
+    send("info string " + tt_.describe());
+  } else if (name == "clear hash") {
+    tt_.clear(hardwareThreads());
+  } else if (name == "move overhead") {
+    moveOverhead_ = std::clamp(std::atoi(value.c_str()), 0, MAX_MOVE_OVERHEAD);
+  } else if (name == "evalfile") {
+    if (value.empty() || value == "<empty>") {
+      if (nnue::isLoaded()) {
+        nnue::unloadNetwork();
+        search_.clear();
+      }
+      return;
+    }
+    if (!nnue::loadNetwork(value)) {
+      send("info string Could not load network " + value);
+      return;
+    }
+    search_.clear(); // Cached evaluations came from the old network
+    send("info string Loaded network " + value + " (" +
+         nnue::activeKernels().name + " kernels)");
+  } else if (name == "ownbook") {
+    ownBook_ = value == "true";
+  } else if (name == "bookfile") {
+    book_.close();
+    if (value.empty() || value == "<empty>")
+      return;
+    if (!book_.open(value)) {
+      send("info string Could not open book " + value);
+      return;
+    }
+    send("info string Loaded book " + value + " (" +
+         std::to_string(book_.size()) + " entries)");
+  } else if (name == "best book move") {
+    bestBookMove_ = value == "true";
+  } else if (name == "syzygypath") {
+    const int found = syzygy::init(value);
+    if (found)
+      send("info string Found " + std::to_string(found) +
+           " tablebases, up to " + std::to_string(syzygy::largest()) +
+           " pieces");
+    else if (!value.empty() && value != "<empty>")
+      send("info string No tablebases in " + value);
+  } else if (name == "syzygyprobedepth") {
+    syzygyProbeDepth_ = std::clamp(std::atoi(value.c_str()), 1, 100);
+  } else if (name == "syzygy50moverule") {
+    syzygy50MoveRule_ = value == "true";
+  } else if (name == "syzygyprobelimit") {
+    syzygyProbeLimit_ =
+        std::clamp(std::atoi(value.c_str()), 0, MAX_SYZYGY_PIECES);
+  } else if (name != "ponder") {
+    send("info string Unknown option: " + name);
+  }
+}
+
+void Uci::ponderHit() {
+  search_.ponderHit();
+  {
+    std::lock_guard<std::mutex> lock(releaseMutex_);
+    ponderHitReceived_ = true;
+  }
+  releaseCondition_.notify_all();
+}
+
+// Not part of UCI: epd <file> [nodes n] [movetime ms] [depth d] [threads t]
+// solves a test suite, by default for one second per position on every
+// core. Each thread gets a hash table of the Hash option's size.
+void Uci::solveEpd(std::istringstream &args) {
+  std::string path, token;
+  args >> path;
+  SearchLimits limits;
+  limits.moveOverhead = 0;
+  limits.syzygyProbeDepth = syzygyProbeDepth_;
+  limits.syzygyProbeLimit = syzygyProbeLimit_;
+  limits.syzygy50MoveRule = syzygy50MoveRule_;
+  int threads = hardwareThreads();
+  while (args >> token) {
+    if (token == "nodes")
+      args >> limits.nodes;
+    else if (token == "movetime")
+      args >> limits.moveTime;
+    else if (token == "depth")
+      args >> limits.depth;
+    else if (token == "threads")
+      args >> threads;
+  }
+  if (!limits.nodes && !limits.moveTime && limits.depth == MAX_PLY - 1)
+    limits.moveTime = 1000;
+
+  std::ifstream file(path);
+  if (!file) {
+    send("info string Could not open " + path);
+    return;
+  }
+  std::vector<EpdPosition> positions;
+  std::string line, error;
+  for (int number = 1; std::getline(file, line); ++number) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos ||
+        line[0] == '#')
+      continue;
+    EpdPosition position;
+    if (!parseEpd(line, position, error)) {
+      send("info string " + path + ":" + std::to_string(number) + ": " +
+           error);
+      continue;
+    }
+    if (position.id.empty())
+      position.id = path + ":" + std::to_string(number);
+    positions.push_back(std::move(position));
+  }
+
+  EpdRunner runner(threads, static_cast<size_t>(hashMegabytes_));
+  EpdReport report = runner.run(
+      positions, limits,
+      [this](const EpdPosition &position, const SearchResult &result,
+             bool solved) {
+        Board board;
+        board.fromFEN(position.fen);
+        std::string line = "info string " + position.id +
+                           (solved ? " solved " : " failed ") +
+                           moveToSan(board, result.bestMove);
+        for (const Move &move : position.bestMoves)
+          line += " bm " + moveToSan(board, move);
+        for (const Move &move : position.avoidMoves)
+          line += " am " + moveToSan(board, move);
+        send(line);
+      });
+  const uint64_t milliseconds = std::max<int64_t>(report.time, 1);
+  send("info string epd solved " + std::to_string(report.solved) + "/" +
+       std::to_string(report.total) + " time " +
+       std::to_string(report.time) + " nodes " +
+       std::to_string(report.nodes) + " nps " +
+       std::to_string(report.nodes * 1000 / milliseconds));
+}
+
+void Uci::runSearch(SearchLimits limits) {
+  SearchResult result = search_.think(board_, limits);
+
+  // UCI forbids bestmove before stop during an infinite search, and before
+  // ponderhit or stop while pondering.
+  if (limits.infinite || limits.ponder) {
+    std::unique_lock<std::mutex> lock(releaseMutex_);
+    releaseCondition_.wait(lock, [&] {
+      return stopRequested_ || (!limits.infinite && ponderHitReceived_);
+    });
+  }
+
+  send("info string evalcache hits " + std::to_string(result.evalCacheHits) +
+       " misses " + std::to_string(result.evalCacheMisses));
+  // No legal move at the root: UCI's null move, never a made-up square.
+  if (result.pv.empty()) {
+    send("bestmove 0000");
+    searching_.store(false);
+    return;
+  }
+  std::string line = "bestmove " + moveToUci(result.bestMove);
+  if (result.pv.size() > 1)
+    line += " ponder " + moveToUci(result.pv[1]);
+  send(line);
+  searching_.store(false);
+}
+
+void Uci::stopSearch() {
+  if (!searchThread_.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(releaseMutex_);
+    stopRequested_ = true;
+  }
+  releaseCondition_.notify_all();
+  // Repeated because a search that has not started yet clears the flag.
+  while (searching_.load()) {
+    search_.stop();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  searchThread_.join();
+}
+
+void Uci::sendInfo(const SearchResult &result) {
+  std::string line = "info depth " + std::to_string(result.depth) +
+                     " score " + scoreToUci(result.score) + " nodes " +
+                     std::to_string(result.nodes) + " nps " +
+                     std::to_string(result.nodes * 1000 /
+                                    std::max<int64_t>(result.time, 1)) +
+                     " time " + std::to_string(result.time) + " hashfull " +
+                     std::to_string(tt_.hashfull()) + " tbhits " +
+                     std::to_string(result.tbHits) + " pv";
+  for (const Move &move : result.pv)
+    line += " " + moveToUci(move);
+  send(line);
+}
+
+void Uci::send(const std::string &line) {
+  std::lock_guard<std::mutex> lock(outputMutex_);
+  out_ << line << std::endl;
+}
+
+} // namespace chess
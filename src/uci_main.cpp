@@ -0,0 +1,130 @@
+#include "batch.hpp"
+#include "book_builder.hpp"
+#include "mapped_file.hpp"
+#include "nnue.hpp"
+#include "nnue_kernels.hpp"
+#include "uci.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace {
+
+bool loadNetwork(const std::string &path) {
+  if (!chess::nnue::loadNetwork(path)) {
+    std::cerr << "Could not load network " << path << "\n";
+    return false;
+  }
+  std::cerr << "Loaded network " << path << " ("
+            << chess::nnue::activeKernels().name << " kernels)\n";
+  return true;
+}
+
+// chess-uci batch [depth d] [nodes n] [threads t] [hash mb] [evalfile path]
+//                 [file]
+// Analyzes the FENs in file, or on stdin, and writes JSON lines to stdout.
+int runBatch(int argc, char *argv[]) {
+  chess::SearchLimits limits;
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  size_t hashMegabytes = 256;
+  std::string input;
+  for (int i = 0; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "depth" && hasValue)
+      limits.depth = std::clamp(std::atoi(argv[++i]), 1, chess::MAX_PLY - 1);
+    else if (arg == "nodes" && hasValue)
+      limits.nodes = std::strtoull(argv[++i], nullptr, 10);
+    else if (arg == "threads" && hasValue)
+      threads = std::max(std::atoi(argv[++i]), 1);
+    else if (arg == "hash" && hasValue)
+      hashMegabytes = std::max(std::atoi(argv[++i]), 1);
+    else if (arg == "evalfile" && hasValue) {
+      if (!loadNetwork(argv[++i]))
+        return 1;
+    } else
+      input = arg;
+  }
+  if (limits.depth == chess::MAX_PLY - 1 && !limits.nodes)
+    limits.depth = 10;
+
+  std::ifstream file;
+  if (!input.empty()) {
+    file.open(input);
+    if (!file) {
+      std::cerr << "Could not open " << input << "\n";
+      return 1;
+    }
+  }
+  std::ios::sync_with_stdio(false);
+  chess::BatchAnalyzer analyzer(threads, hashMegabytes);
+  std::cerr << analyzer.getHashTable().describe() << "\n";
+  chess::BatchReport report =
+      analyzer.run(input.empty() ? std::cin : file, std::cout, limits);
+  std::cerr << report.positions << " positions, " << report.invalid
+            << " invalid, " << report.nodes << " nodes\n";
+  return 0;
+}
+
+// chess-uci book build <pgn> <book> [plies n] [min n] [threads t]
+// Writes a Polyglot book of the first plies (default 20) of the games,
+// keeping moves played in at least min (default 3) of them.
+int buildBook(int argc, char *argv[]) {
+  if (argc < 3 || std::string(argv[0]) != "build") {
+    std::cerr << "Usage: chess-uci book build <pgn> <book> [plies n] "
+                 "[min n] [threads t]\n";
+    return 1;
+  }
+  int plies = 20, minGames = 3;
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  for (int i = 3; i + 1 < argc; i += 2) {
+    const std::string arg = argv[i];
+    if (arg == "plies")
+      plies = std::max(std::atoi(argv[i + 1]), 1);
+    else if (arg == "min")
+      minGames = std::max(std::atoi(argv[i + 1]), 1);
+    else if (arg == "threads")
+      threads = std::max(std::atoi(argv[i + 1]), 1);
+  }
+
+  chess::MappedFile pgn;
+  if (!pgn.open(argv[1])) {
+    std::cerr << "Could not open " << argv[1] << "\n";
+    return 1;
+  }
+  chess::BookBuilder builder(threads, plies, minGames);
+  chess::BookBuildReport report;
+  if (!builder.build(pgn.view(), argv[2], report)) {
+    std::cerr << "Could not write " << argv[2] << "\n";
+    return 1;
+  }
+  std::cerr << report.games << " games, " << report.skipped << " skipped, "
+            << report.moves << " moves, " << report.entries
+            << " book entries\n";
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc > 1 && std::string(argv[1]) == "batch")
+    return runBatch(argc - 2, argv + 2);
+  if (argc > 1 && std::string(argv[1]) == "book")
+    return buildBook(argc - 2, argv + 2);
+
+  // Optional NNUE network; the classical evaluation is used without one.
+  // The EvalFile option can load one later.
+  if (argc > 1) {
+    if (chess::nnue::loadNetwork(argv[1]))
+      std::cout << "info string Loaded network " << argv[1] << " ("
+                << chess::nnue::activeKernels().name << " kernels)\n";
+    else
+      std::cerr << "Could not load network " << argv[1] << "\n";
+  }
+
+  chess::Uci uci(std::cin, std::cout);
+  uci.loop();
+  return 0;
+}
@@ -1,6 +1,30 @@
+#include "batch.hpp"
 #include "board.hpp"
+#include "book.hpp"
+#include "book_builder.hpp"
 #include "catch_amalgamated.hpp" // Include Catch2
+#include "endgame.hpp"
+#include "epd.hpp"
+#include "eval_cache.hpp"
+#include "evaluation.hpp"
+#include "history.hpp"
+#include "material.hpp"
 #include "move_generator.hpp"
+#include "nnue.hpp"
+#include "nnue_kernels.hpp"
+#include "notation.hpp"
+#include "pawn_table.hpp"
+#include "pgn.hpp"
+#include "search.hpp"
+#include "see.hpp"
+#include "syzygy.hpp"
+#include "transposition_table.hpp"
+#include "uci.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
 
 TEST_CASE("Pawn Moves", "[MoveGenerator]") {
   chess::MoveGenerator moveGen;
@@ -114,3 +138,1205 @@ TEST_CASE("King Moves", "[MoveGenerator]") {
     REQUIRE(moves.size() == 8);
   }
 }
+TEST_CASE("Special Moves", "[MoveGenerator]") {
+  chess::MoveGenerator moveGen;
+  chess::Board board;
+  board.clear();
+  SECTION("Promotions") {
+    board.setPiece(6, 0,
+                   chess::Piece(chess::PieceType::PAWN, chess::Color::WHITE));
+    std::vector<chess::Move> moves =
+        moveGen.generateMoves(board, chess::Color::WHITE);
+    REQUIRE(moves.size() == 4); // Queen, rook, bishop and knight
+    REQUIRE(std::find(moves.begin(), moves.end(),
+                      chess::Move(6, 0, 7, 0, chess::PieceType::KNIGHT)) !=
+            moves.end());
+  }
+  SECTION("En Passant") {
+    board.setPiece(4, 4,
+                   chess::Piece(chess::PieceType::PAWN, chess::Color::WHITE));
+    board.setPiece(6, 3,
+                   chess::Piece(chess::PieceType::PAWN, chess::Color::BLACK));
+    board.setSideToMove(chess::Color::BLACK);
+    board.makeMove(chess::Move(6, 3, 4, 3)); // d7-d5
+    std::vector<chess::Move> moves =
+        moveGen.generateMoves(board, chess::Color::WHITE);
+    REQUIRE(std::find(moves.begin(), moves.end(), chess::Move(4, 4, 5, 3)) !=
+            moves.end()); // exd6
+    board.makeMove(chess::Move(4, 4, 5, 3));
+    REQUIRE(board.getPiece(4, 3).isEmpty());
+  }
+  SECTION("Castling") {
+    board.setPiece(0, 4,
+                   chess::Piece(chess::PieceType::KING, chess::Color::WHITE));
+    board.setPiece(0, 7,
+                   chess::Piece(chess::PieceType::ROOK, chess::Color::WHITE));
+    board.setPiece(0, 0,
+                   chess::Piece(chess::PieceType::ROOK, chess::Color::WHITE));
+    board.setCastlingRights(chess::WHITE_KINGSIDE | chess::WHITE_QUEENSIDE);
+    std::vector<chess::Move> moves =
+        moveGen.generateMoves(board, chess::Color::WHITE);
+    REQUIRE(std::find(moves.begin(), moves.end(), chess::Move(0, 4, 0, 6)) !=
+            moves.end());
+    REQUIRE(std::find(moves.begin(), moves.end(), chess::Move(0, 4, 0, 2)) !=
+            moves.end());
+
+    // A rook covering f1 forbids castling through it.
+    board.setPiece(7, 5,
+                   chess::Piece(chess::PieceType::ROOK, chess::Color::BLACK));
+    moves = moveGen.generateMoves(board, chess::Color::WHITE);
+    REQUIRE(std::find(moves.begin(), moves.end(), chess::Move(0, 4, 0, 6)) ==
+            moves.end());
+  }
+  SECTION("Captures Only") {
+    board.setPiece(3, 3,
+                   chess::Piece(chess::PieceType::ROOK, chess::Color::WHITE));
+    board.setPiece(3, 6,
+                   chess::Piece(chess::PieceType::KNIGHT, chess::Color::BLACK));
+    chess::MoveList moves;
+    moveGen.generateCaptures(board, chess::Color::WHITE, moves);
+    REQUIRE(moves.size() == 1);
+    REQUIRE(moves[0] == chess::Move(3, 3, 3, 6));
+  }
+}
+TEST_CASE("Make and Unmake", "[Board]") {
+  chess::MoveGenerator moveGen;
+  chess::Board board;
+  const uint64_t hash = board.getHash();
+  const uint64_t pawnKey = board.getPawnKey();
+  const uint64_t materialKey = board.getMaterialKey();
+  for (const chess::Move &move :
+       moveGen.generateMoves(board, chess::Color::WHITE)) {
+    board.makeMove(move);
+    REQUIRE(board.getSideToMove() == chess::Color::BLACK);
+    bool pawnMove = board.getPiece(move.endRow, move.endCol).getType() ==
+                    chess::PieceType::PAWN;
+    REQUIRE((board.getPawnKey() != pawnKey) == pawnMove);
+    REQUIRE(board.getMaterialKey() == materialKey); // No captures yet
+    board.unmakeMove(move);
+    REQUIRE(board.getHash() == hash);
+    REQUIRE(board.getPawnKey() == pawnKey);
+    REQUIRE(board.getPawns(chess::Color::WHITE) == 0xFF00ULL);
+  }
+}
+TEST_CASE("Null Move", "[Board]") {
+  chess::Board board;
+  // Black may take en passant on d6; passing gives up that right.
+  REQUIRE(board.fromFEN(
+      "rnbqkbnr/ppp1pppp/8/8/3pP3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 3"));
+  const std::string fen = board.toFEN();
+  const uint64_t hash = board.getHash();
+
+  board.makeNullMove();
+  REQUIRE(board.getSideToMove() == chess::Color::WHITE);
+  REQUIRE(board.getEnPassantCol() == -1);
+  chess::Board passed;
+  REQUIRE(passed.fromFEN(
+      "rnbqkbnr/ppp1pppp/8/8/3pP3/8/PPPP1PPP/RNBQKBNR w KQkq - 0 3"));
+  REQUIRE(board.getHash() == passed.getHash());
+
+  board.unmakeNullMove();
+  REQUIRE(board.toFEN() == fen);
+  REQUIRE(board.getHash() == hash);
+
+  // Null-move pruning is skipped for a side with only king and pawns.
+  REQUIRE(board.hasNonPawnMaterial(chess::Color::WHITE));
+  REQUIRE(board.fromFEN("4k3/4p3/8/8/8/8/3PP3/2N1K3 w - - 0 1"));
+  REQUIRE(board.hasNonPawnMaterial(chess::Color::WHITE));
+  REQUIRE_FALSE(board.hasNonPawnMaterial(chess::Color::BLACK));
+}
+
+TEST_CASE("Piece-Square Totals", "[Board]") {
+  chess::Board board;
+  REQUIRE(board.getMidgameScore() == 0); // Symmetric
+  REQUIRE(board.getEndgameScore() == 0);
+
+  // The colour-flipped position scores the same for the other side.
+  REQUIRE(board.fromFEN("4k3/8/8/8/8/2N5/1P6/4K3 w - - 0 1"));
+  const int midgame = board.getMidgameScore();
+  const int endgame = board.getEndgameScore();
+  REQUIRE(midgame > 0);
+  REQUIRE(board.fromFEN("4k3/1p6/2n5/8/8/8/8/4K3 w - - 0 1"));
+  REQUIRE(board.getMidgameScore() == -midgame);
+  REQUIRE(board.getEndgameScore() == -endgame);
+
+  // Random games, promotions included, keep the totals a fresh board would
+  // compute.
+  chess::MoveGenerator moveGen;
+  std::mt19937 random(34);
+  auto matchesFreshBoard = [&board] {
+    chess::Board fresh;
+    REQUIRE(fresh.fromFEN(board.toFEN()));
+    REQUIRE(board.getMidgameScore() == fresh.getMidgameScore());
+    REQUIRE(board.getEndgameScore() == fresh.getEndgameScore());
+  };
+  for (const char *fen :
+       {"r3k2r/1P4P1/8/3pP3/8/8/1p4p1/R3K2R w KQkq d6 0 1",
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"}) {
+    REQUIRE(board.fromFEN(fen));
+    std::vector<chess::Move> line;
+    for (int ply = 0; ply < 150; ++ply) {
+      std::vector<chess::Move> legal;
+      for (const chess::Move &move :
+           moveGen.generateMoves(board, board.getSideToMove())) {
+        board.makeMove(move);
+        if (!board.isInCheck(chess::opposite(board.getSideToMove())))
+          legal.push_back(move);
+        board.unmakeMove(move);
+      }
+      if (legal.empty())
+        break;
+      line.push_back(legal[random() % legal.size()]);
+      board.makeMove(line.back());
+      matchesFreshBoard();
+    }
+    while (!line.empty()) {
+      board.unmakeMove(line.back());
+      line.pop_back();
+    }
+    matchesFreshBoard();
+    chess::Board start;
+    REQUIRE(start.fromFEN(fen));
+    REQUIRE(board.toFEN() == start.toFEN());
+  }
+}
+
+TEST_CASE("FEN", "[Board]") {
+  const char *start =
+      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+  chess::Board board;
+  REQUIRE(board.toFEN() == start);
+
+  SECTION("Round Trip") {
+    const char *fen =
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R b Kq - 3 17";
+    REQUIRE(board.fromFEN(fen));
+    REQUIRE(board.toFEN() == fen);
+    REQUIRE(board.getSideToMove() == chess::Color::BLACK);
+    REQUIRE(board.getHalfmoveClock() == 3);
+    REQUIRE(board.getFullmoveNumber() == 17);
+  }
+
+  SECTION("Matches Played Moves") {
+    board.makeMove(chess::Move(1, 4, 3, 4)); // e2e4
+    chess::Board loaded;
+    REQUIRE(loaded.fromFEN(
+        "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1"));
+    REQUIRE(loaded.getHash() == board.getHash());
+    REQUIRE(loaded.toFEN() == board.toFEN());
+  }
+
+  SECTION("Rejects Invalid Positions") {
+    REQUIRE_FALSE(board.fromFEN("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP w KQkq -"));
+    REQUIRE_FALSE(board.fromFEN("4k3/8/8/8/8/8/8/4K3 x - -"));
+    REQUIRE_FALSE(board.fromFEN("4k3/8/8/8/8/8/8/4K2R w Q -")); // No rook
+    REQUIRE_FALSE(board.fromFEN("4k3/8/8/8/8/8/8/4K3 w - e6")); // No pawn
+    REQUIRE_FALSE(board.fromFEN("4k3/8/8/8/8/8/8/3QK4 b - -")); // 9 files
+    REQUIRE_FALSE(board.fromFEN("4k3/4Q3/8/8/8/8/8/4K3 w - -")); // In check
+    REQUIRE_FALSE(board.fromFEN("4k3/8/8/8/8/8/8/4K3 w - - 0 0"));
+    REQUIRE_FALSE(board.fromFEN("4k3/8/8/8/8/8/8/4K3 w - - -5 1"));
+    REQUIRE_FALSE(board.fromFEN("4k3/8/8/8/8/8/8/4K3 w - - 0 -1"));
+    REQUIRE(board.getHash() == 0); // Left empty
+    REQUIRE(board.fromFEN("4k3/8/8/8/8/8/8/4K3 w - -"));
+  }
+}
+TEST_CASE("Eval Cache", "[Evaluation]") {
+  chess::EvalCache cache;
+  int eval = 0;
+  // Keys with clear top bits must not match an empty slot.
+  REQUIRE_FALSE(cache.probe(0x1234, eval));
+  cache.store(0x1234, -57);
+  REQUIRE(cache.probe(0x1234, eval));
+  REQUIRE(eval == -57);
+  REQUIRE_FALSE(cache.probe(0x1234 | 1ULL << 60, eval)); // Same slot
+  REQUIRE(cache.getHits() == 1);
+  REQUIRE(cache.getMisses() == 2);
+  cache.clear();
+  REQUIRE(cache.getHits() == 0);
+  REQUIRE_FALSE(cache.probe(0x1234, eval));
+}
+
+TEST_CASE("Pawn Structure", "[Evaluation]") {
+  chess::Board board;
+  chess::PawnTable table;
+  // Endgame pawn terms from White's point of view, from a fresh table so
+  // that nothing is served from a previous probe.
+  auto pawnScore = [&board](const char *fen) {
+    REQUIRE(board.fromFEN(fen));
+    return chess::PawnTable().probe(board).endgameScore;
+  };
+
+  SECTION("Terms") {
+    REQUIRE(pawnScore("4k3/2pp4/8/8/8/8/2PP4/4K3 w - - 0 1") == 0);
+    // Doubled c-pawns against a healthy chain.
+    REQUIRE(pawnScore("4k3/2pp4/8/8/8/2P5/2PP4/4K3 w - - 0 1") <
+            pawnScore("4k3/2pp4/8/8/8/8/2PPP3/4K3 w - - 0 1"));
+    // Two isolated pawns against two connected ones.
+    REQUIRE(pawnScore("4k3/1pp5/8/8/8/8/P1P5/4K3 w - - 0 1") <
+            pawnScore("4k3/1pp5/8/8/8/8/1PP5/4K3 w - - 0 1"));
+    // A passed pawn, worth more the further it has advanced.
+    const int blocked = pawnScore("4k3/5p2/8/4P3/8/8/8/4K3 w - - 0 1");
+    const int passed = pawnScore("4k3/7p/8/4P3/8/8/8/4K3 w - - 0 1");
+    REQUIRE(table.probe(board).passedPawns ==
+            std::array<chess::Bitboard, 2>{chess::squareBit(4, 4),
+                                           chess::squareBit(6, 7)});
+    REQUIRE(passed > blocked);
+    REQUIRE(pawnScore("4k3/7p/4P3/8/8/8/8/4K3 w - - 0 1") > passed);
+  }
+
+  SECTION("Colour Symmetry") {
+    chess::Evaluator evaluator;
+    auto evaluate = [&](const char *fen) {
+      REQUIRE(board.fromFEN(fen));
+      return evaluator.evaluate(board);
+    };
+    REQUIRE(pawnScore("8/5pk1/1p4p1/p2P4/P7/1P3K2/8/8 b - - 0 1") ==
+            -pawnScore("8/8/1p3k2/p7/P2p4/1P4P1/5PK1/8 w - - 0 1"));
+    REQUIRE(evaluate("8/5pk1/1p4p1/p2P4/P7/1P3K2/8/8 b - - 0 1") ==
+            evaluate("8/8/1p3k2/p7/P2p4/1P4P1/5PK1/8 w - - 0 1"));
+    REQUIRE(evaluate("r1bqk2r/pp3ppp/2n1pn2/3p4/1bPP4/2N1PN2/P4PPP/"
+                     "R1BQKB1R w KQkq - 0 1") ==
+            evaluate("r1bqkb1r/p4ppp/2n1pn2/1Bpp4/3P4/2N1PN2/PP3PPP/"
+                     "R1BQK2R b KQkq - 0 1"));
+  }
+
+  SECTION("Cached Entries") {
+    REQUIRE(board.fromFEN("8/5pk1/1p4p1/p2P4/P7/1P3K2/8/8 b - - 0 1"));
+    chess::PawnEntry &entry = table.probe(board);
+    // Same pawns, other pieces: the cached entry, with the fresh scores.
+    REQUIRE(board.fromFEN("2r5/5p2/1p3kp1/p2P4/P7/1P6/4K3/3R4 w - - 0 1"));
+    REQUIRE(&table.probe(board) == &entry);
+    const chess::PawnEntry fresh = chess::PawnTable().probe(board);
+    REQUIRE(entry.midgameScore == fresh.midgameScore);
+    REQUIRE(entry.endgameScore == fresh.endgameScore);
+    REQUIRE(entry.passedPawns == fresh.passedPawns);
+  }
+}
+
+TEST_CASE("Material", "[Evaluation]") {
+  chess::Board board;
+  chess::Evaluator evaluator;
+  auto evaluate = [&](const char *fen) {
+    REQUIRE(board.fromFEN(fen));
+    return evaluator.evaluate(board);
+  };
+  const int knownWin = chess::endgame::VALUE_KNOWN_WIN;
+
+  SECTION("KPK") {
+    // King on the sixth in front of its pawn wins whoever moves.
+    REQUIRE(evaluate("4k3/8/4K3/4P3/8/8/8/8 w - - 0 1") > knownWin);
+    REQUIRE(evaluate("4k3/8/4K3/4P3/8/8/8/8 b - - 0 1") < -knownWin);
+    // Outside the square of the pawn.
+    REQUIRE(evaluate("7k/8/8/8/P7/8/8/K7 w - - 0 1") > knownWin);
+    // The same for Black, with the ranks flipped.
+    REQUIRE(evaluate("8/8/8/8/4p3/4k3/8/4K3 b - - 0 1") > knownWin);
+
+    // Rook pawn against a king in the corner, stalemate and a lost pawn.
+    REQUIRE(evaluate("k7/8/8/8/8/8/P7/K7 w - - 0 1") == 0);
+    REQUIRE(evaluate("4k3/4P3/4K3/8/8/8/8/8 b - - 0 1") == 0);
+    REQUIRE(evaluate("8/8/8/8/8/8/4Pk2/K7 b - - 0 1") == 0);
+    REQUIRE(evaluate("8/8/8/8/8/8/4pK2/k7 w - - 0 1") == 0);
+  }
+
+  SECTION("KBNK And KXK") {
+    // Mate is only forced in a corner of the bishop's colour; h8 is dark
+    // like c1, a8 is not. The kings are equally far apart.
+    const int rightCorner = evaluate("7k/8/8/8/8/2K5/3N4/2B5 w - - 0 1");
+    const int wrongCorner = evaluate("k7/8/8/8/8/2K5/3N4/2B5 w - - 0 1");
+    REQUIRE(wrongCorner > knownWin);
+    REQUIRE(rightCorner > wrongCorner);
+
+    REQUIRE(evaluate("k7/8/8/8/8/8/8/KR6 w - - 0 1") > knownWin);
+    REQUIRE(evaluate("k7/8/8/8/8/8/8/KR6 b - - 0 1") < -knownWin);
+    REQUIRE(evaluate("2k5/8/8/8/8/8/8/KQ6 b - - 0 1") < -knownWin);
+    REQUIRE(evaluate("k7/8/8/8/8/8/8/KNN5 w - - 0 1") == 0);
+  }
+
+  SECTION("Scale Factors") {
+    chess::MaterialTable table;
+    // The bishop cannot cover a8, and the defending king holds the corner.
+    REQUIRE(board.fromFEN("k7/8/8/8/8/8/P7/K1B5 w - - 0 1"));
+    REQUIRE(table.probe(board).scale(board, chess::Color::WHITE) ==
+            chess::endgame::SCALE_DRAW);
+    REQUIRE(board.fromFEN("k7/8/8/8/8/8/P7/KB6 w - - 0 1"));
+    REQUIRE(table.probe(board).scale(board, chess::Color::WHITE) >
+            chess::endgame::SCALE_DRAW);
+    // Opposite bishops with one extra pawn.
+    REQUIRE(board.fromFEN("4k3/p7/8/3b4/8/8/PP6/2B1K3 w - - 0 1"));
+    REQUIRE(table.probe(board).scale(board, chess::Color::WHITE) == 16);
+    // A minor piece up without pawns cannot win.
+    REQUIRE(board.fromFEN("4k3/8/8/8/8/8/8/2B1K1n1 w - - 0 1"));
+    REQUIRE(table.probe(board).scale(board, chess::Color::WHITE) ==
+            chess::endgame::SCALE_DRAW);
+  }
+
+  SECTION("Cached Entries") {
+    chess::MaterialTable table;
+    REQUIRE(board.fromFEN("4k3/8/8/8/8/8/4P3/4K3 w - - 0 1"));
+    chess::MaterialEntry &entry = table.probe(board);
+    REQUIRE(entry.key == board.getMaterialKey());
+    REQUIRE(entry.evaluation == chess::endgame::evaluateKPK);
+    REQUIRE(entry.strongSide == chess::Color::WHITE);
+    entry.midgameImbalance = 1234; // Marks the entry as the cached one
+
+    // Same pieces on other squares: the entry is found, not recomputed.
+    REQUIRE(board.fromFEN("8/8/2k5/8/5P2/8/1K6/8 b - - 0 1"));
+    REQUIRE(&table.probe(board) == &entry);
+    REQUIRE(entry.midgameImbalance == 1234);
+
+    REQUIRE(board.fromFEN("4k3/8/8/8/8/8/4p3/4K3 w - - 0 1"));
+    REQUIRE(table.probe(board).strongSide == chess::Color::BLACK);
+  }
+}
+
+TEST_CASE("Move Notation", "[Notation]") {
+  chess::Board board;
+  REQUIRE(board.fromFEN("r3k3/1P6/8/R7/8/8/8/R3K2R w KQq - 0 1"));
+  const chess::Move castle(0, 4, 0, 2);
+  const chess::Move promotion(6, 1, 7, 0, chess::PieceType::QUEEN);
+
+  REQUIRE(chess::moveToUci(promotion) == "b7a8q");
+  REQUIRE(chess::parseUciMove(board, "b7a8q") == promotion);
+  REQUIRE(chess::parseUciMove(board, "e1e3") == chess::Move());
+
+  REQUIRE(chess::moveToSan(board, castle) == "O-O-O");
+  REQUIRE(chess::moveToSan(board, promotion) == "bxa8=Q+");
+  REQUIRE(chess::moveToSan(board, chess::Move(0, 0, 2, 0)) == "R1a3");
+  REQUIRE(chess::parseSanMove(board, "O-O-O") == castle);
+  REQUIRE(chess::parseSanMove(board, "bxa8Q") == promotion);
+  REQUIRE(chess::parseSanMove(board, "Ra3") == chess::Move()); // Ambiguous
+  REQUIRE(chess::parseSanMove(board, "Ra1a3") == chess::Move(0, 0, 2, 0));
+  REQUIRE(chess::parseSanMove(board, "Ra3a4") == chess::Move());
+  REQUIRE(board.toFEN() == "r3k3/1P6/8/R7/8/8/8/R3K2R w KQq - 0 1");
+}
+TEST_CASE("EPD", "[Notation]") {
+  chess::EpdPosition position;
+  std::string error;
+
+  SECTION("Parsing") {
+    REQUIRE(chess::parseEpd("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/"
+                            "RNBQKB1R w KQkq - bm Bb5 Bc4; am Nxe5;"
+                            " id \"test 1\"; c0 \"ignored\";",
+                            position, error));
+    REQUIRE(position.id == "test 1");
+    REQUIRE(position.bestMoves ==
+            std::vector<chess::Move>{chess::Move(0, 5, 4, 1),
+                                     chess::Move(0, 5, 3, 2)});
+    REQUIRE(position.avoidMoves ==
+            std::vector<chess::Move>{chess::Move(2, 5, 4, 4)});
+    chess::Board board;
+    REQUIRE(board.fromFEN(position.fen));
+    REQUIRE(board.getCastlingRights() ==
+            (chess::WHITE_KINGSIDE | chess::WHITE_QUEENSIDE |
+             chess::BLACK_KINGSIDE | chess::BLACK_QUEENSIDE));
+
+    auto fails = [&](const char *line, const std::string &reason) {
+      REQUIRE_FALSE(chess::parseEpd(line, position, error));
+      REQUIRE(error == reason);
+    };
+    fails("8/8/8/8 w -", "missing position fields");
+    fails("8/8/8/8/8/8/8/8 w - - bm Ka1;", "invalid position");
+    fails("4k3/8/8/8/8/8/8/4K3 w - - bm Ke3;", "illegal move Ke3");
+    fails("4k3/8/8/8/8/8/8/4K3 w - - id \"kings\";", "no bm or am operation");
+  }
+
+  SECTION("Runner") {
+    std::vector<chess::EpdPosition> positions(3);
+    REQUIRE(chess::parseEpd("6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - bm Rd8#;",
+                            positions[0], error));
+    REQUIRE(chess::parseEpd("6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - am Rd8#;",
+                            positions[1], error));
+    REQUIRE(chess::parseEpd("3q3k/8/8/8/8/8/8/3QK3 w - - bm Qxd8+;",
+                            positions[2], error));
+    chess::SearchLimits limits;
+    limits.depth = 4;
+    // Results arrive on the workers; assertions stay on this thread.
+    std::vector<int> depths;
+    chess::EpdReport report = chess::EpdRunner(2, 1).run(
+        positions, limits,
+        [&](const chess::EpdPosition &, const chess::SearchResult &result,
+            bool) { depths.push_back(result.depth); });
+    REQUIRE(depths == std::vector<int>{4, 4, 4});
+    REQUIRE(report.total == 3);
+    REQUIRE(report.solved == 2); // Mate is found, so "am" fails
+    REQUIRE(report.nodes > 0);
+  }
+}
+
+TEST_CASE("PGN", "[Notation]") {
+  const char *text = "[Event \"One\"]\n[Result \"1-0\"]\n\n"
+                     "1. e4 {comment} e5 2. Nf3 (2. f4 exf4) 2... Nc6 $1 "
+                     "3. Bb5 1-0\n\n"
+                     "[Event \"Two\"]\n"
+                     "[FEN \"6k1/5ppp/8/8/8/8/8/K2R4 w - - 0 1\"]\n\n"
+                     "1. Rd8# 1-0\n\n"
+                     "[Event \"Three\"]\n\n"
+                     "1 d4 d5 2 c4 1/2-1/2\n";
+  chess::PgnReader reader(text);
+  chess::PgnGame game;
+  chess::Board board;
+  int moves = 0;
+  auto count = [&](const chess::Board &, const chess::Move &) {
+    ++moves;
+    return true;
+  };
+
+  REQUIRE(reader.next(game));
+  REQUIRE(game.tag("Event") == "One");
+  REQUIRE(chess::replayPgnGame(game, board, count));
+  REQUIRE(moves == 5);
+  REQUIRE(board.toFEN() ==
+          "r1bqkbnr/pppp1ppp/2n5/1B2p3/4P3/5N2/PPPP1PPP/RNBQK2R b KQkq - 3 3");
+
+  REQUIRE(reader.next(game));
+  REQUIRE(chess::replayPgnGame(game, board, count));
+  REQUIRE(moves == 6);
+
+  // Bare move numbers, without the dot.
+  REQUIRE(reader.next(game));
+  REQUIRE(chess::replayPgnGame(game, board, count));
+  REQUIRE(moves == 9);
+  REQUIRE_FALSE(reader.next(game));
+  REQUIRE(chess::splitPgn(text, 2).size() == 2);
+}
+
+TEST_CASE("Opening Book", "[Book]") {
+  chess::Board board;
+  const chess::Move e4(1, 4, 3, 4), d4(1, 3, 3, 3);
+
+  // Reference keys from the Polyglot book format description.
+  REQUIRE(chess::bookKey(board) == 0x463b96181691fc9cULL);
+  board.makeMove(e4);
+  REQUIRE(chess::bookKey(board) == 0x823c9b50fd114196ULL);
+  board.makeMove(chess::Move(6, 3, 4, 3));
+  REQUIRE(chess::bookKey(board) == 0x0756b94461c50fb0ULL);
+  board.unmakeMove(chess::Move(6, 3, 4, 3));
+  board.unmakeMove(e4);
+
+  // Polyglot files store big-endian entries sorted by key.
+  std::vector<std::pair<uint64_t, uint16_t>> entries = {
+      {chess::bookKey(board), chess::encodeBookMove(board, d4)},
+      {chess::bookKey(board), chess::encodeBookMove(board, e4)},
+      {chess::bookKey(board), 0}}; // a1a1, illegal
+  std::sort(entries.begin(), entries.end());
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "chess_book_test.bin").string();
+  {
+    std::ofstream out(path, std::ios::binary);
+    for (const auto &[key, move] : entries) {
+      const uint16_t weight = move == chess::encodeBookMove(board, e4) ? 3 : 1;
+      const uint64_t fields[] = {key, move, weight, 0};
+      const int sizes[] = {8, 2, 2, 4};
+      for (int field = 0; field < 4; ++field)
+        for (int byte = sizes[field] - 1; byte >= 0; --byte)
+          out.put(static_cast<char>(fields[field] >> (8 * byte) & 0xFF));
+    }
+  }
+
+  chess::OpeningBook book;
+  REQUIRE(book.open(path));
+  std::vector<chess::BookMove> moves = book.probe(board);
+  REQUIRE(moves.size() == 2);
+  REQUIRE(moves[0].move == e4);
+  REQUIRE(moves[1].move == d4);
+  REQUIRE(book.pickMove(board, true, 3) == e4);
+  REQUIRE(book.pickMove(board, false, 3) == d4);
+  board.makeMove(e4);
+  REQUIRE(book.probe(board).empty());
+  book.close();
+  std::filesystem::remove(path);
+
+  // En passant only counts when a pawn can take, as in Polyglot.
+  chess::Board other;
+  REQUIRE(other.fromFEN("4k3/8/8/8/4P3/8/8/4K3 b - e3 0 1"));
+  const uint64_t key = chess::bookKey(other);
+  REQUIRE(other.fromFEN("4k3/8/8/8/4P3/8/8/4K3 b - - 0 1"));
+  REQUIRE(chess::bookKey(other) == key);
+  REQUIRE(other.fromFEN("4k3/8/8/8/3pP3/8/8/4K3 b - e3 0 1"));
+  const uint64_t capturable = chess::bookKey(other);
+  REQUIRE(other.fromFEN("4k3/8/8/8/3pP3/8/8/4K3 b - - 0 1"));
+  REQUIRE(chess::bookKey(other) != capturable);
+}
+
+TEST_CASE("Book Builder", "[Book]") {
+  const char *pgn = "[Result \"1-0\"]\n\n1. e4 e5 2. Nf3 1-0\n\n"
+                    "[Result \"1/2-1/2\"]\n\n1. e4 c5 1/2-1/2\n\n"
+                    "[Result \"0-1\"]\n\n1. d4 d5 0-1\n\n"
+                    "[Result \"*\"]\n\n1. c4 *\n";
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "chess_builder_test.bin")
+          .string();
+  chess::BookBuilder builder(2, 2, 1);
+  chess::BookBuildReport report;
+  REQUIRE(builder.build(pgn, path, report));
+  REQUIRE(report.games == 3);
+  REQUIRE(report.skipped == 1);
+  REQUIRE(report.moves == 6);
+
+  // 1. e4 won once and drew once; 1. d4 lost; Nf3 is beyond two plies.
+  chess::OpeningBook book;
+  REQUIRE(book.open(path));
+  chess::Board board;
+  std::vector<chess::BookMove> moves = book.probe(board);
+  REQUIRE(moves.size() == 1);
+  REQUIRE(moves[0].move == chess::Move(1, 4, 3, 4));
+  REQUIRE(moves[0].weight == 3);
+  board.makeMove(chess::Move(1, 3, 3, 3));
+  REQUIRE(book.probe(board).size() == 1);
+  board.unmakeMove(chess::Move(1, 3, 3, 3));
+  board.makeMove(moves[0].move);
+  REQUIRE(book.probe(board).size() == 1); // c5 drew, e5 lost
+  book.close();
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Syzygy", "[Syzygy]") {
+  // KQvK with one value per side to move: white wins, black loses.
+  const std::filesystem::path dir =
+      std::filesystem::temp_directory_path() / "chess_syzygy_test";
+  std::filesystem::create_directories(dir);
+  {
+    const unsigned char bytes[] = {0x71, 0xE8, 0x23, 0x5D, // Magic
+                                   0x01,                   // Split
+                                   0x00, 0x55, 0x66, 0xEE, // Order, QKk
+                                   0x00,                   // Padding
+                                   0x80, 0x04, 0x80, 0x00};
+    std::ofstream out(dir / "KQvK.rtbw", std::ios::binary);
+    out.write(reinterpret_cast<const char *>(bytes), sizeof(bytes));
+  }
+  REQUIRE(chess::syzygy::init(dir.string()) == 1);
+  REQUIRE(chess::syzygy::largest() == 3);
+
+  chess::Board board;
+  int wdl = 0;
+  REQUIRE(board.fromFEN("8/8/8/4k3/8/8/8/KQ6 w - - 0 1"));
+  REQUIRE(chess::syzygy::probeWdl(board, wdl));
+  REQUIRE(wdl == chess::syzygy::WDL_WIN);
+  REQUIRE(board.fromFEN("kq6/8/8/8/4K3/8/8/8 b - - 0 1"));
+  REQUIRE(chess::syzygy::probeWdl(board, wdl));
+  REQUIRE(wdl == chess::syzygy::WDL_WIN);
+  // Captures are resolved past the table: the queen hangs.
+  REQUIRE(board.fromFEN("8/8/8/8/8/2k5/2Q5/K7 b - - 0 1"));
+  REQUIRE(chess::syzygy::probeWdl(board, wdl));
+  REQUIRE(wdl == chess::syzygy::WDL_DRAW);
+  REQUIRE(board.fromFEN("4k3/8/8/8/8/8/8/QQ2K3 w - - 0 1"));
+  REQUIRE_FALSE(chess::syzygy::probeWdl(board, wdl));
+
+  // Without .rtbz files, root moves fall back to WDL ranks.
+  REQUIRE(board.fromFEN("8/8/8/8/8/2k5/8/KQ6 w - - 0 1"));
+  std::vector<chess::syzygy::RootMove> moves = {{chess::Move(0, 1, 1, 1)},
+                                                {chess::Move(0, 1, 1, 2)}};
+  REQUIRE_FALSE(chess::syzygy::rankRootMoves(board, moves));
+  REQUIRE(chess::syzygy::rankRootMovesByWdl(board, moves));
+  REQUIRE(moves[0].rank == 1000); // Qb2+, defended
+  REQUIRE(moves[1].rank == 0);    // Qc2+?, Kxc2
+
+  chess::syzygy::init("");
+  std::filesystem::remove_all(dir);
+}
+
+namespace {
+
+// Weights of a HalfKP 256x2-32-32-1 network, written in the .nnue layout.
+struct TestNetwork {
+  std::vector<int16_t> featureBiases =
+      std::vector<int16_t>(chess::nnue::HALF_DIMENSIONS);
+  std::vector<int16_t> featureWeights = std::vector<int16_t>(
+      size_t(chess::nnue::INPUT_DIMENSIONS) * chess::nnue::HALF_DIMENSIONS);
+  std::vector<int32_t> hidden1Biases = std::vector<int32_t>(32);
+  std::vector<int8_t> hidden1Weights = std::vector<int8_t>(32 * 512, 1);
+  std::vector<int32_t> hidden2Biases = std::vector<int32_t>(32);
+  std::vector<int8_t> hidden2Weights = std::vector<int8_t>(32 * 32, 1);
+  std::vector<int32_t> outputBias = std::vector<int32_t>(1);
+  std::vector<int8_t> outputWeights = std::vector<int8_t>(32, 1);
+
+  void write(const std::string &path) const {
+    std::ofstream out(path, std::ios::binary);
+    auto put = [&out](const auto &values) {
+      out.write(reinterpret_cast<const char *>(values.data()),
+                static_cast<std::streamsize>(values.size() *
+                                             sizeof(values[0])));
+    };
+    const std::string description = "test";
+    put(std::vector<uint32_t>{0x7AF32F16, 0,
+                              static_cast<uint32_t>(description.size())});
+    put(description);
+    put(std::vector<uint32_t>{0});
+    put(featureBiases);
+    put(featureWeights);
+    put(std::vector<uint32_t>{0});
+    put(hidden1Biases);
+    put(hidden1Weights);
+    put(hidden2Biases);
+    put(hidden2Weights);
+    put(outputBias);
+    put(outputWeights);
+  }
+};
+
+// Small random weights that keep every layer inside its clipping range
+// often enough for the evaluation to depend on all the inputs.
+TestNetwork randomNetwork(std::mt19937 &random) {
+  TestNetwork network;
+  auto fill = [&random](auto &values, int low, int high) {
+    for (auto &value : values)
+      value = static_cast<std::decay_t<decltype(value)>>(
+          low + static_cast<int>(random() % (high - low + 1)));
+  };
+  fill(network.featureBiases, 0, 63);
+  fill(network.featureWeights, -16, 16);
+  fill(network.hidden1Weights, -4, 4);
+  fill(network.hidden2Weights, -8, 8);
+  fill(network.outputWeights, -127, 127);
+  return network;
+}
+
+} // namespace
+
+TEST_CASE("NNUE", "[NNUE]") {
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "chess_nnue_test.nnue")
+          .string();
+  chess::Board board;
+
+  SECTION("Feature Index") {
+    // Only the input "own pawn on e2, king on e1" has weight. Black sees the
+    // board rotated, so its pawn on d7 with the king on d8 is the same input.
+    TestNetwork network;
+    const int input = 12 + 1 + chess::nnue::PIECE_SQUARE_COUNT * 4;
+    std::fill_n(network.featureWeights.begin() +
+                    input * chess::nnue::HALF_DIMENSIONS,
+                chess::nnue::HALF_DIMENSIONS, int16_t(64));
+    network.write(path);
+    REQUIRE(chess::nnue::loadNetwork(path));
+    REQUIRE(chess::nnue::isLoaded());
+    REQUIRE(chess::nnue::getDescription() == "test");
+
+    auto evaluate = [&board](const char *fen) {
+      REQUIRE(board.fromFEN(fen));
+      return chess::nnue::AccumulatorStack().evaluate(board);
+    };
+    REQUIRE(evaluate("4k3/8/8/8/8/8/8/4K3 w - - 0 1") == 0);
+    REQUIRE(evaluate("4k3/8/8/8/8/8/4P3/4K3 w - - 0 1") > 0);
+    REQUIRE(evaluate("4k3/8/8/8/8/8/4P3/4K3 b - - 0 1") > 0);
+    REQUIRE(evaluate("3k4/3p4/8/8/8/8/8/4K3 w - - 0 1") > 0);
+    REQUIRE(evaluate("4k3/8/8/8/8/8/3P4/4K3 w - - 0 1") == 0);
+    REQUIRE(evaluate("4k3/8/8/8/8/8/4P3/3K4 w - - 0 1") == 0);
+    REQUIRE(evaluate("4k3/8/8/8/8/8/4p3/4K3 w - - 0 1") == 0);
+    REQUIRE(evaluate("4k3/4p3/8/8/8/8/8/4K3 w - - 0 1") == 0);
+  }
+
+  SECTION("Incremental Updates Match A Refresh") {
+    std::mt19937 random(37);
+    randomNetwork(random).write(path);
+    REQUIRE(chess::nnue::loadNetwork(path));
+
+    // The lazy stack only evaluates some plies, so updates span several
+    // moves, including captures, castling and king moves.
+    chess::MoveGenerator moveGen;
+    chess::nnue::AccumulatorStack stack;
+    std::vector<chess::Move> line;
+    for (int ply = 0; ply < 120; ++ply) {
+      std::vector<chess::Move> legal;
+      for (const chess::Move &move :
+           moveGen.generateMoves(board, board.getSideToMove())) {
+        board.makeMove(move);
+        if (!board.isInCheck(chess::opposite(board.getSideToMove())))
+          legal.push_back(move);
+        board.unmakeMove(move);
+      }
+      if (legal.empty())
+        break;
+      line.push_back(legal[random() % legal.size()]);
+      board.makeMove(line.back());
+      if (random() % 3 == 0)
+        REQUIRE(stack.evaluate(board) ==
+                chess::nnue::AccumulatorStack().evaluate(board));
+    }
+    while (!line.empty()) {
+      board.unmakeMove(line.back());
+      line.pop_back();
+      REQUIRE(stack.evaluate(board) ==
+              chess::nnue::AccumulatorStack().evaluate(board));
+    }
+  }
+
+  SECTION("Refresh Cache") {
+    // One stack evaluates unrelated positions with the kings on the same
+    // squares, so each refresh starts from the entry the previous position
+    // left for that king square.
+    std::mt19937 random(39);
+    randomNetwork(random).write(path);
+    REQUIRE(chess::nnue::loadNetwork(path));
+    chess::nnue::AccumulatorStack stack;
+    const char *fens[] = {
+        "r1bqk2r/pppp1ppp/2n2n2/2b1p3/2B1P3/3P1N2/PPP2PPP/RNBQK2R w KQkq - 0 1",
+        "4k3/pp3ppp/8/8/8/8/PP3PPP/4K3 w - - 0 1",
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "4k3/8/8/3qQ3/8/8/8/4K3 b - - 0 1",
+        "r1bqk2r/pppp1ppp/2n2n2/2b1p3/2B1P3/3P1N2/PPP2PPP/RNBQK2R w KQkq - 0 1",
+    };
+    for (const char *fen : fens) {
+      REQUIRE(board.fromFEN(fen));
+      REQUIRE(stack.evaluate(board) ==
+              chess::nnue::AccumulatorStack().evaluate(board));
+    }
+
+    // A king walking back and forth while the other pieces change is
+    // refreshed from entries that go stale between its visits.
+    REQUIRE(board.fromFEN("r3k3/1p6/8/8/8/8/6P1/4K2R w - - 0 1"));
+    const chess::Move walk[] = {
+        chess::Move(0, 4, 0, 5), chess::Move(7, 0, 7, 2),
+        chess::Move(0, 5, 0, 4), chess::Move(6, 1, 5, 1),
+        chess::Move(0, 4, 0, 5), chess::Move(7, 2, 7, 0),
+        chess::Move(0, 5, 0, 4), chess::Move(5, 1, 4, 1),
+        chess::Move(1, 6, 3, 6), chess::Move(7, 4, 7, 3)};
+    for (const chess::Move &move : walk) {
+      board.makeMove(move);
+      REQUIRE(stack.evaluate(board) ==
+              chess::nnue::AccumulatorStack().evaluate(board));
+    }
+
+    // Loading another network invalidates everything cached.
+    randomNetwork(random).write(path);
+    REQUIRE(chess::nnue::loadNetwork(path));
+    REQUIRE(stack.evaluate(board) ==
+            chess::nnue::AccumulatorStack().evaluate(board));
+  }
+
+  chess::nnue::unloadNetwork();
+  REQUIRE_FALSE(chess::nnue::isLoaded());
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("NNUE Kernels", "[NNUE]") {
+  // Every set this CPU supports must match the scalar reference exactly.
+  const std::vector<const chess::nnue::Kernels *> kernels =
+      chess::nnue::supportedKernels();
+  const chess::nnue::Kernels &scalar = *kernels.back();
+  REQUIRE(std::string(scalar.name) == "scalar");
+  REQUIRE(&chess::nnue::activeKernels() == kernels.front());
+
+  std::mt19937 random(38);
+  auto fill = [&random](auto &values, int low, int high) {
+    for (auto &value : values)
+      value = static_cast<std::decay_t<decltype(value)>>(
+          low + static_cast<int>(random() % (high - low + 1)));
+  };
+
+  for (const chess::nnue::Kernels *set : kernels) {
+    INFO(set->name);
+
+    std::vector<int16_t> weights(chess::nnue::HALF_DIMENSIONS);
+    std::vector<int16_t> values(chess::nnue::HALF_DIMENSIONS);
+    fill(weights, -2000, 2000);
+    fill(values, -8000, 8000);
+    std::vector<int16_t> expected = values;
+    set->addRow(values.data(), weights.data());
+    scalar.addRow(expected.data(), weights.data());
+    REQUIRE(values == expected);
+    set->subtractRow(values.data(), weights.data());
+    scalar.subtractRow(expected.data(), weights.data());
+    REQUIRE(values == expected);
+
+    // 96 inputs take the wide kernels' fallback for odd multiples of 32.
+    for (int inputs : {32, 96, 512}) {
+      for (int outputs : {1, 32}) {
+        std::vector<uint8_t> input(inputs);
+        std::vector<int8_t> matrix(size_t(inputs) * outputs);
+        std::vector<int32_t> biases(outputs);
+        fill(input, 0, 127);
+        fill(matrix, -128, 127);
+        fill(biases, -10000, 10000);
+        std::vector<int32_t> output(outputs), reference(outputs);
+        set->affine(input.data(), inputs, matrix.data(), biases.data(),
+                    outputs, output.data());
+        scalar.affine(input.data(), inputs, matrix.data(), biases.data(),
+                      outputs, reference.data());
+        REQUIRE(output == reference);
+      }
+    }
+  }
+}
+
+TEST_CASE("Transposition Table", "[Search]") {
+  chess::TranspositionTable tt(1);
+  chess::TTEntry entry;
+  // Keys differing only in their low bits share a cluster of four slots,
+  // and this one is among the clusters hashfull() samples.
+  const uint64_t key = 0xAB0000000000ULL;
+
+  SECTION("Store And Probe") {
+    REQUIRE_FALSE(tt.probe(key, entry));
+    tt.store(key, 7, -250, 40, chess::Bound::LOWER, 0x1234);
+    REQUIRE(tt.probe(key, entry));
+    REQUIRE(entry.move == 0x1234);
+    REQUIRE(entry.score == -250);
+    REQUIRE(entry.eval == 40);
+    REQUIRE(entry.depth == 7);
+    REQUIRE(entry.bound == chess::Bound::LOWER);
+    REQUIRE_FALSE(tt.probe(key + 1, entry));
+
+    // A new result without a move keeps the old one.
+    tt.store(key, 9, 30, 40, chess::Bound::EXACT, 0);
+    REQUIRE(tt.probe(key, entry));
+    REQUIRE(entry.move == 0x1234);
+    REQUIRE(entry.depth == 9);
+    REQUIRE(entry.bound == chess::Bound::EXACT);
+
+    tt.clear();
+    REQUIRE_FALSE(tt.probe(key, entry));
+  }
+
+  SECTION("Replacement") {
+    const int depths[] = {10, 3, 8, 12};
+    for (int i = 0; i < 4; ++i)
+      tt.store(key + i, depths[i], 0, 0, chess::Bound::EXACT, 1);
+    tt.store(key + 4, 5, 0, 0, chess::Bound::EXACT, 1);
+    REQUIRE(tt.probe(key + 4, entry));
+    REQUIRE_FALSE(tt.probe(key + 1, entry)); // The shallowest went
+    REQUIRE(tt.probe(key, entry));
+    REQUIRE(tt.probe(key + 2, entry));
+    REQUIRE(tt.probe(key + 3, entry));
+  }
+
+  SECTION("Generations") {
+    for (int i = 0; i < 4; ++i)
+      tt.store(key + i, 10 + i, 0, 0, chess::Bound::EXACT, 1);
+    REQUIRE(tt.hashfull() > 0);
+    tt.newSearch();
+    tt.newSearch();
+    REQUIRE(tt.hashfull() == 0); // Only entries of this search count
+
+    // Entries from earlier searches give way first, even deep ones.
+    for (int i = 4; i < 8; ++i)
+      tt.store(key + i, 1, 0, 0, chess::Bound::EXACT, 1);
+    for (int i = 0; i < 4; ++i)
+      REQUIRE_FALSE(tt.probe(key + i, entry));
+    for (int i = 4; i < 8; ++i)
+      REQUIRE(tt.probe(key + i, entry));
+  }
+}
+
+TEST_CASE("Static Exchange Evaluation", "[Search]") {
+  chess::Board board;
+  // seeGe is exact: true up to the exchange's value, false beyond it.
+  auto value = [&board](const char *fen, const chess::Move &move, int gain) {
+    REQUIRE(board.fromFEN(fen));
+    REQUIRE(chess::seeGe(board, move, gain));
+    REQUIRE_FALSE(chess::seeGe(board, move, gain + 1));
+  };
+
+  // Rxe5 wins an undefended pawn.
+  value("1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1",
+        chess::Move(0, 4, 4, 4), 100);
+  // Nxe5 gives up the knight for a pawn.
+  value("1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1",
+        chess::Move(2, 3, 4, 4), -220);
+  // Qxe5 dxe5.
+  value("4k3/8/3p4/4p3/8/8/8/4QK2 w - - 0 1", chess::Move(0, 4, 4, 4), -800);
+  // The rook on e1 recaptures through the one on e2.
+  value("4k3/4r3/8/4p3/8/8/4R3/4R2K w - - 0 1", chess::Move(1, 4, 4, 4), 100);
+  // The king takes back only when the square is not defended.
+  value("8/8/8/8/8/2k5/3p4/3R2K1 w - - 0 1", chess::Move(0, 3, 1, 3), -400);
+  value("8/8/8/6B1/8/2k5/3p4/3R2K1 w - - 0 1", chess::Move(0, 3, 1, 3), 100);
+}
+
+TEST_CASE("History Heuristics", "[Search]") {
+  auto history = std::make_unique<chess::HistoryTables>();
+  history->clear();
+
+  SECTION("Killers") {
+    const chess::Move first(1, 4, 3, 4), second(0, 6, 2, 5);
+    history->storeKiller(5, first);
+    history->storeKiller(5, first); // Not stored twice
+    REQUIRE(history->killers[5][0] == first);
+    REQUIRE(history->killers[5][1] == chess::Move());
+    history->storeKiller(5, second);
+    REQUIRE(history->killers[5][0] == second);
+    REQUIRE(history->killers[5][1] == first);
+    REQUIRE(history->killers[6][0] == chess::Move());
+    history->clearKillers();
+    REQUIRE(history->killers[5][0] == chess::Move());
+  }
+
+  SECTION("Gravity") {
+    int16_t &entry = history->butterfly[0][12][28];
+    chess::updateHistory(entry, 400);
+    REQUIRE(entry == 400);
+    chess::updateHistory(entry, 400);
+    REQUIRE(entry == 800 - 400 * 400 / chess::MAX_HISTORY);
+    // Repeated bonuses saturate below the bound instead of overflowing,
+    // and a run of maluses swings the entry back.
+    for (int i = 0; i < 1000; ++i)
+      chess::updateHistory(entry, 2000);
+    REQUIRE(entry > chess::MAX_HISTORY - 2000);
+    REQUIRE(entry <= chess::MAX_HISTORY);
+    for (int i = 0; i < 1000; ++i)
+      chess::updateHistory(entry, -2000);
+    REQUIRE(entry < -chess::MAX_HISTORY + 2000);
+    REQUIRE(entry >= -chess::MAX_HISTORY);
+
+    chess::PieceToHistory &context =
+        history->continuation[chess::pieceIndex(chess::Color::WHITE,
+                                                chess::PieceType::KNIGHT)]
+                             [chess::squareIndex(2, 5)];
+    chess::updateHistory(context[chess::pieceIndex(chess::Color::BLACK,
+                                                   chess::PieceType::PAWN)]
+                                [chess::squareIndex(4, 3)],
+                         -300);
+    history->clear();
+    REQUIRE(entry == 0);
+    REQUIRE(context[6][35] == 0);
+  }
+}
+
+TEST_CASE("Time Management", "[Search]") {
+  chess::TimeManager time;
+  chess::SearchLimits limits;
+  limits.moveOverhead = 30;
+
+  SECTION("No Clock") {
+    time.start(limits, chess::Color::WHITE);
+    REQUIRE_FALSE(time.isActive());
+    REQUIRE_FALSE(time.hardLimitReached());
+    REQUIRE_FALSE(time.shouldStopIteration(0, 0, 0.0));
+
+    limits.whiteTime = 60000;
+    limits.infinite = true;
+    time.start(limits, chess::Color::WHITE);
+    REQUIRE_FALSE(time.isActive());
+  }
+
+  SECTION("Move Time") {
+    limits.moveTime = 1000;
+    time.start(limits, chess::Color::WHITE);
+    REQUIRE(time.isActive());
+    REQUIRE(time.getSoftLimit() == 970);
+    REQUIRE(time.getHardLimit() == 970);
+  }
+
+  SECTION("Clock") {
+    // A thirtieth of the clock plus most of the increment, with up to four
+    // times that when the search is unsettled.
+    limits.whiteTime = 60000;
+    limits.whiteIncrement = 1000;
+    limits.blackTime = 6000;
+    time.start(limits, chess::Color::WHITE);
+    REQUIRE(time.getSoftLimit() == 59970 / 30 + 750);
+    REQUIRE(time.getHardLimit() == 4 * (59970 / 30 + 750));
+    REQUIRE_FALSE(time.shouldStopIteration(0, 0, 0.0));
+
+    time.start(limits, chess::Color::BLACK);
+    REQUIRE(time.getSoftLimit() == 5970 / 30);
+
+    // Never more than 80% of the clock, even for the last move before the
+    // time control.
+    limits.movesToGo = 1;
+    time.start(limits, chess::Color::WHITE);
+    REQUIRE(time.getHardLimit() == 59970 * 4 / 5);
+    REQUIRE(time.getSoftLimit() == 59970 * 4 / 5);
+
+    limits.whiteTime = 20; // Less than the overhead
+    time.start(limits, chess::Color::WHITE);
+    REQUIRE(time.getSoftLimit() >= 1);
+    REQUIRE(time.getHardLimit() >= time.getSoftLimit());
+  }
+}
+
+TEST_CASE("Search", "[Search]") {
+  chess::TranspositionTable tt(4);
+  chess::Search search(tt);
+  chess::Board board;
+  chess::SearchLimits limits;
+
+  SECTION("Mate In Two") {
+    // Rd8+ Rxd8 Rxd8#. Past the first iterations every depth is searched
+    // with a null window for the later moves and an aspiration window at
+    // the root, and the exact mate score must survive both.
+    const char *fen = "r5k1/5ppp/8/8/8/8/3R1PPP/3R2K1 w - - 0 1";
+    REQUIRE(board.fromFEN(fen));
+    const uint64_t hash = board.getHash();
+    limits.depth = 6;
+    chess::SearchResult result = search.think(board, limits);
+    REQUIRE(board.getHash() == hash); // Searched in place and restored
+    REQUIRE(result.bestMove == chess::Move(1, 3, 7, 3));
+    REQUIRE(result.score == chess::VALUE_MATE - 3);
+    REQUIRE(result.pv.size() == 3);
+    REQUIRE(result.depth == 6);
+  }
+
+  SECTION("Mate In Three") {
+    // Qxc8+ Rxc8 Rd8+ Rxd8 Rxd8#. Each reply is forced, so the TT move is
+    // singular at every black node, and the mate must still be exact.
+    REQUIRE(board.fromFEN("r1r3k1/5ppp/8/8/8/8/2QR1PPP/3R2K1 w - - 0 1"));
+    limits.depth = 8;
+    chess::SearchResult result = search.think(board, limits);
+    REQUIRE(result.bestMove == chess::Move(1, 2, 7, 2));
+    REQUIRE(result.score == chess::VALUE_MATE - 5);
+    REQUIRE(result.pv.size() == 5);
+
+    // A second search through the warm table agrees.
+    result = search.think(board, limits);
+    REQUIRE(result.bestMove == chess::Move(1, 2, 7, 2));
+    REQUIRE(result.score == chess::VALUE_MATE - 5);
+  }
+
+  SECTION("Node Limit") {
+    // Small budgets are honoured closely, not rounded up to a poll interval.
+    limits.nodes = 100;
+    chess::SearchResult result = search.think(board, limits);
+    REQUIRE(result.nodes >= 100);
+    REQUIRE(result.nodes <= 110);
+    REQUIRE(result.bestMove != chess::Move());
+  }
+
+  SECTION("Stalemate") {
+    REQUIRE(board.fromFEN("7k/5Q2/6K1/8/8/8/8/8 b - - 0 1"));
+    limits.depth = 4;
+    chess::SearchResult result = search.think(board, limits);
+    REQUIRE(result.score == chess::VALUE_DRAW);
+    REQUIRE(result.bestMove == chess::Move());
+
+    // Every king move stalemates, as do queen moves that still cover a7, b7
+    // and b8. Late quiet moves are reduced, yet must still be seen through.
+    REQUIRE(board.fromFEN("k7/8/1Q6/8/8/8/8/6K1 w - - 0 1"));
+    limits.depth = 8;
+    result = search.think(board, limits);
+    REQUIRE(result.score > 500);
+    board.makeMove(result.bestMove);
+    chess::MoveGenerator moveGen;
+    bool canMove = false;
+    for (const chess::Move &move :
+         moveGen.generateMoves(board, chess::Color::BLACK)) {
+      board.makeMove(move);
+      canMove |= !board.isInCheck(chess::Color::BLACK);
+      board.unmakeMove(move);
+    }
+    REQUIRE(canMove);
+  }
+}
+
+TEST_CASE("UCI", "[UCI]") {
+  // The searches below are cut short by the end of the input, but the root
+  // is restricted with searchmoves, so the reply is still known.
+  auto run = [](const std::string &commands) {
+    std::istringstream in(commands);
+    std::ostringstream out;
+    chess::Uci uci(in, out);
+    uci.loop();
+    std::vector<std::string> lines;
+    std::istringstream reply(out.str());
+    for (std::string line; std::getline(reply, line);)
+      lines.push_back(line);
+    return lines;
+  };
+  auto find = [](const std::vector<std::string> &lines,
+                 const std::string &line) {
+    return static_cast<size_t>(std::find(lines.begin(), lines.end(), line) -
+                               lines.begin());
+  };
+  // The move of the last bestmove line; any ponder move is left out.
+  auto bestMove = [](const std::vector<std::string> &lines) {
+    std::string word, move;
+    for (const std::string &line : lines) {
+      std::istringstream words(line);
+      if (words >> word && word == "bestmove")
+        words >> move;
+    }
+    return move;
+  };
+
+  SECTION("Handshake") {
+    std::vector<std::string> lines =
+        run("uci\nisready\nfoo bar\nquit\nisready\n");
+    REQUIRE(lines.front() == "id name ChessEngine");
+    REQUIRE(find(lines, "uciok") < find(lines, "readyok"));
+    REQUIRE(lines[find(lines, "uciok") + 1].rfind(
+                "info string Hash 16 MB backed by ", 0) == 0);
+    REQUIRE(lines.back() == "info string Unknown command: foo bar");
+    REQUIRE(std::count(lines.begin(), lines.end(), "readyok") == 1);
+
+    // The table reports its size and backing again after a resize.
+    lines = run("setoption name Hash value 4\n");
+    REQUIRE(lines.size() == 1);
+    REQUIRE(lines[0].rfind("info string Hash 4 MB backed by ", 0) == 0);
+  }
+
+  SECTION("Position And Go") {
+    std::vector<std::string> lines =
+        run("position startpos moves e2e4 e7e5\n"
+            "go depth 30 searchmoves g1f3\n");
+    REQUIRE(bestMove(lines) == "g1f3");
+    REQUIRE(std::count_if(lines.begin(), lines.end(), [](auto &line) {
+              return line.rfind("bestmove", 0) == 0;
+            }) == 1);
+
+    // Castling moved the rook to f1, so Ke8-f7 is illegal.
+    lines = run("position fen 4k3/8/8/8/8/8/8/4K2R w K - 0 1 moves e1g1 e8f7\n"
+                "position fen 4k3/8/8/8/8/8/8/4K2R w K - 0 1 moves e1g1\n"
+                "go infinite searchmoves e8d8\nstop\n");
+    REQUIRE(lines.front() == "info string Illegal move: e8f7");
+    REQUIRE(bestMove(lines) == "e8d8");
+  }
+
+  SECTION("No Legal Move") {
+    // Mated, then stalemated: the null move, with no ponder move.
+    std::vector<std::string> lines =
+        run("position fen 7k/5QQ1/8/8/8/8/8/K7 b - - 0 1\ngo depth 3\n"
+            "isready\n");
+    REQUIRE(find(lines, "bestmove 0000") < lines.size());
+    lines = run("position fen 7k/5Q2/6K1/8/8/8/8/8 b - - 0 1\ngo depth 3\n"
+                "isready\n");
+    REQUIRE(find(lines, "bestmove 0000") < lines.size());
+  }
+
+  SECTION("Bad Input") {
+    std::vector<std::string> lines =
+        run("position startpos moves e2e4 e7e6 e4e6\n"
+            "go depth 30 searchmoves e7e5\n"
+            "position fen 9/8 w - - 0 1\n"
+            "position\n");
+    REQUIRE(find(lines, "info string Illegal move: e4e6") < lines.size());
+    // The moves before the illegal one were played: White is to move.
+    REQUIRE(bestMove(lines) != "e7e5");
+    REQUIRE(find(lines, "info string Invalid FEN: 9/8 w - - 0 1 ") <
+            lines.size());
+    REQUIRE(lines.back() == "info string Expected startpos or fen");
+  }
+}
+
+TEST_CASE("Batch Analysis", "[UCI]") {
+  // Three workers, yet the output keeps the input order. Blank lines are
+  // skipped and Windows line endings are tolerated.
+  std::istringstream in("6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1\r\n"
+                        "\n"
+                        "not a \"fen\"\n"
+                        "7k/5Q2/6K1/8/8/8/8/8 b - - 0 1\n");
+  std::ostringstream out;
+  chess::SearchLimits limits;
+  limits.depth = 3;
+  chess::BatchReport report = chess::BatchAnalyzer(3, 1).run(in, out, limits);
+  REQUIRE(report.positions == 3);
+  REQUIRE(report.invalid == 1);
+  REQUIRE(report.nodes > 0);
+
+  std::vector<std::string> lines;
+  std::istringstream reply(out.str());
+  for (std::string line; std::getline(reply, line);)
+    lines.push_back(line);
+  REQUIRE(lines.size() == 3);
+  auto startsWith = [](const std::string &line, const std::string &prefix) {
+    return line.compare(0, prefix.size(), prefix) == 0;
+  };
+  REQUIRE(startsWith(lines[0], R"({"fen":"6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - )"
+                               R"(0 1","depth":3,"score":{"mate":1},)"
+                               R"("bestmove":"d1d8","pv":["d1d8"],"nodes":)"));
+  REQUIRE(lines[0].find(R"(,"evalcache":{"hits":)") != std::string::npos);
+  REQUIRE(lines[0].back() == '}');
+  REQUIRE(lines[1] == R"({"fen":"not a \"fen\"","error":"invalid FEN"})");
+  // Stalemate: a draw and no move.
+  REQUIRE(startsWith(lines[2], R"({"fen":"7k/5Q2/6K1/8/8/8/8/8 b - - 0 1",)"
+                               R"("depth":3,"score":{"cp":0},)"
+                               R"("bestmove":null,"pv":[],)"));
+}